@@ -0,0 +1,606 @@
+// host_bench.c - Host-native checks and microbenchmarks for string.c,
+// memory.c and fs.c
+//
+// Built by `make host-bench` (Linux). The kernel modules are compiled
+// unchanged with host_shim.h forced in, so they can be profiled with perf
+// or valgrind before booting QEMU:
+//
+//   ./build/host/host_bench              all checks and benchmarks
+//   ./build/host/host_bench fs           benchmarks whose name starts with fs
+//   ./build/host/host_bench --check      checks only
+//
+// Results are printed as a table and as KV records in the same format the
+// kernel writes to serial (KV event=hostbench ...). Exit status is 1 when a
+// check fails.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+// libc versions for cross-checks, captured before the shim renames them
+static size_t (*libc_strlen)(const char*) = strlen;
+static int (*libc_strcmp)(const char*, const char*) = strcmp;
+static int (*libc_memcmp)(const void*, const void*, size_t) = memcmp;
+static char* (*libc_strchr)(const char*, int) = strchr;
+
+#include "host_shim.h"
+#include "string.h"
+#include "memory.h"
+#include "fs.h"
+#include "trace.h"
+
+#define BENCH_RUNS      15
+#define FS_DIRS         56  // Plus the sample entries, fits in the root directory
+#define FS_FILES_PER_DIR 64
+#define FS_DEEP_LEVELS  48
+#define CHURN_OPS       200000
+#define CHURN_LIVE      512
+
+static int failures = 0;
+static const char* filter = NULL;
+
+// The kernel trace ring is not part of the host build
+void trace_event(uint16_t id, uint32_t arg0, uint32_t arg1) {
+    (void)id;
+    (void)arg0;
+    (void)arg1;
+}
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+// Deterministic pseudo-random numbers (LCG) so runs are comparable
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 8;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static int bench_selected(const char* name) {
+    return !filter || strncmp(name, filter, strlen(filter)) == 0;
+}
+
+// Time run(ops) BENCH_RUNS times after a warm-up, report ns per operation
+static void bench(const char* name, uint32_t ops, void (*setup)(void), void (*run)(uint32_t ops)) {
+    double runs[BENCH_RUNS];
+    
+    if (!bench_selected(name)) {
+        return;
+    }
+    
+    if (setup) {
+        setup();
+    }
+    run(ops);
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        if (setup) {
+            setup();
+        }
+        double start = now_ns();
+        run(ops);
+        runs[i] = (now_ns() - start) / ops;
+    }
+    qsort(runs, BENCH_RUNS, sizeof(double), cmp_double);
+    
+    printf("%-18s %10.1f %10.1f %10.1f\n", name, runs[0], runs[BENCH_RUNS / 2], runs[BENCH_RUNS - 1]);
+    printf("KV event=hostbench name=%s ops=%u runs=%d min=%.1f median=%.1f max=%.1f unit=ns\n",
+           name, ops, BENCH_RUNS, runs[0], runs[BENCH_RUNS / 2], runs[BENCH_RUNS - 1]);
+}
+
+// ---------------------------------------------------------------- string.c
+
+static unsigned char buf_a[65536 + 64];
+static unsigned char buf_b[65536 + 64];
+static unsigned char buf_c[65536 + 64];
+static volatile uintptr_t sink;
+
+static void check_string(void) {
+    for (int iter = 0; iter < 20000; iter++) {
+        size_t len = rng() % 300;
+        size_t src_off = rng() % 8;
+        size_t dst_off = rng() % 8;
+        
+        for (size_t i = 0; i < len + 16; i++) {
+            buf_a[i] = rng();
+        }
+        
+        // memcpy must copy exactly len bytes
+        for (size_t i = 0; i < len + 16; i++) {
+            buf_b[i] = buf_c[i] = 0x5A;
+        }
+        k_memcpy(buf_b + dst_off, buf_a + src_off, len);
+        for (size_t i = 0; i < len; i++) {
+            buf_c[dst_off + i] = buf_a[src_off + i];
+        }
+        CHECK(libc_memcmp(buf_b, buf_c, len + 16) == 0, "memcpy len=%zu src+%zu dst+%zu", len, src_off, dst_off);
+        
+        // memset
+        int value = rng() & 0xFF;
+        k_memset(buf_b + dst_off, value, len);
+        for (size_t i = 0; i < len; i++) {
+            buf_c[dst_off + i] = value;
+        }
+        CHECK(libc_memcmp(buf_b, buf_c, len + 16) == 0, "memset len=%zu dst+%zu", len, dst_off);
+        
+        // memcmp sign, with a difference at a random position
+        k_memcpy(buf_c, buf_b, len + 16);
+        if (len > 0) {
+            buf_c[rng() % len] ^= 1 << (rng() % 8);
+        }
+        int expect = libc_memcmp(buf_b, buf_c, len);
+        int got = k_memcmp(buf_b, buf_c, len);
+        CHECK((expect > 0) == (got > 0) && (expect < 0) == (got < 0), "memcmp len=%zu", len);
+        
+        // strlen/strchr/strcmp on NUL-terminated strings at odd offsets
+        char* str = (char*)buf_a + src_off;
+        for (size_t i = 0; i < len; i++) {
+            str[i] = 'a' + rng() % 26;
+        }
+        str[len] = '\0';
+        CHECK((size_t)k_strlen(str) == libc_strlen(str), "strlen len=%zu", len);
+        int c = 'a' + rng() % 26;
+        CHECK(k_strchr(str, c) == libc_strchr(str, c), "strchr len=%zu", len);
+        CHECK(k_strchr(str, '\0') == libc_strchr(str, '\0'), "strchr NUL len=%zu", len);
+        
+        char* copy = (char*)buf_b + dst_off;
+        k_strcpy(copy, str);
+        CHECK(k_strcmp(copy, str) == 0, "strcmp equal len=%zu", len);
+        if (len > 0) {
+            copy[rng() % len]++;
+            expect = libc_strcmp(str, copy);
+            got = k_strcmp(str, copy);
+            CHECK((expect > 0) == (got > 0) && (expect < 0) == (got < 0), "strcmp order len=%zu", len);
+        }
+    }
+}
+
+// Every source/destination alignment 0-7 against every length up to 80
+// and the lengths either side of the word, rep-string and 1KB cut-overs.
+// Guard bytes around each destination catch over- and under-runs
+static const size_t sweep_long_lengths[] = {
+    127, 128, 129, 255, 256, 257, 1023, 1024, 1025, 4095, 4096, 4097,
+};
+#define SWEEP_SHORT     81
+#define SWEEP_LENGTHS   (SWEEP_SHORT + sizeof(sweep_long_lengths) / sizeof(sweep_long_lengths[0]))
+#define SWEEP_GUARD     16
+
+static size_t sweep_length(size_t index) {
+    return index < SWEEP_SHORT ? index : sweep_long_lengths[index - SWEEP_SHORT];
+}
+
+static void check_guards(const unsigned char* buf, size_t off, size_t len, const char* what) {
+    for (size_t i = 0; i < SWEEP_GUARD + off; i++) {
+        CHECK(buf[i] == 0xA5, "%s len=%zu off=%zu wrote before the buffer", what, len, off);
+    }
+    for (size_t i = 0; i < SWEEP_GUARD; i++) {
+        CHECK(buf[SWEEP_GUARD + off + len + i] == 0xA5, "%s len=%zu off=%zu wrote past the end", what, len, off);
+    }
+}
+
+static void check_string_sweep(void) {
+    for (size_t i = 0; i < sizeof(buf_a); i++) {
+        buf_a[i] = rng() | 1;   // No NULs, so string tests control the terminator
+    }
+    
+    for (size_t index = 0; index < SWEEP_LENGTHS; index++) {
+        size_t len = sweep_length(index);
+        for (size_t src_off = 0; src_off < 8; src_off++) {
+            for (size_t dst_off = 0; dst_off < 8; dst_off++) {
+                unsigned char* src = buf_a + SWEEP_GUARD + src_off;
+                unsigned char* dst = buf_b + SWEEP_GUARD + dst_off;
+                
+                k_memset(buf_b, 0xA5, len + 2 * SWEEP_GUARD + 8);
+                CHECK(k_memcpy(dst, src, len) == dst, "memcpy return len=%zu", len);
+                CHECK(libc_memcmp(dst, src, len) == 0, "memcpy len=%zu src+%zu dst+%zu", len, src_off, dst_off);
+                check_guards(buf_b, dst_off, len, "memcpy");
+                
+                // memcmp: equal, then a difference in either direction at
+                // the first, middle and last byte
+                CHECK(k_memcmp(dst, src, len) == 0, "memcmp equal len=%zu src+%zu dst+%zu", len, src_off, dst_off);
+                if (len > 0) {
+                    size_t positions[3] = {0, len / 2, len - 1};
+                    for (int p = 0; p < 3; p++) {
+                        unsigned char saved = dst[positions[p]];
+                        dst[positions[p]] = saved + 1;
+                        int got = k_memcmp(dst, src, len);
+                        int expect = libc_memcmp(dst, src, len);
+                        CHECK((got > 0) == (expect > 0) && (got < 0) == (expect < 0),
+                              "memcmp len=%zu diff at %zu src+%zu dst+%zu", len, positions[p], src_off, dst_off);
+                        got = k_memcmp(src, dst, len);
+                        expect = libc_memcmp(src, dst, len);
+                        CHECK((got > 0) == (expect > 0) && (got < 0) == (expect < 0),
+                              "memcmp reversed len=%zu diff at %zu", len, positions[p]);
+                        dst[positions[p]] = saved;
+                    }
+                }
+            }
+        }
+        
+        // Single-buffer functions: every start alignment
+        for (size_t off = 0; off < 8; off++) {
+            unsigned char* dst = buf_b + SWEEP_GUARD + off;
+            k_memset(buf_b, 0xA5, len + 2 * SWEEP_GUARD + 8);
+            int value = (int)(index * 7 + off) & 0xFF;
+            CHECK(k_memset(dst, value, len) == dst, "memset return len=%zu", len);
+            for (size_t i = 0; i < len; i++) {
+                CHECK(dst[i] == value, "memset len=%zu off=%zu byte %zu", len, off, i);
+            }
+            check_guards(buf_b, off, len, "memset");
+            
+            // The terminator at every position a word-at-a-time scan can
+            // see it, with non-NUL bytes after it in the same word
+            char* str = (char*)buf_c + SWEEP_GUARD + off;
+            k_memcpy(str, buf_a, len + 8);
+            str[len] = '\0';
+            CHECK((size_t)k_strlen(str) == len, "strlen len=%zu off=%zu got %zu", len, off, (size_t)k_strlen(str));
+            
+            // strchr: the first match at every position, a miss, and NUL
+            CHECK(k_strchr(str, '\0') == str + len, "strchr NUL len=%zu off=%zu", len, off);
+            CHECK(k_strchr(str, 0) == libc_strchr(str, 0), "strchr NUL vs libc len=%zu", len);
+            // 2 is never in str: the source bytes are all odd
+            for (size_t i = 0; i < len; i++) {
+                unsigned char saved = str[i];
+                str[i] = 2;
+                CHECK(k_strchr(str, 2) == str + i, "strchr len=%zu off=%zu match at %zu", len, off, i);
+                str[i] = saved;
+            }
+            CHECK(k_strchr(str, 2) == NULL, "strchr miss len=%zu off=%zu", len, off);
+        }
+    }
+}
+
+static void run_memcpy_64(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        k_memcpy(buf_b, buf_a, 64);
+    }
+}
+
+static void run_memcpy_4k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        k_memcpy(buf_b, buf_a, 4096);
+    }
+}
+
+static void run_memcpy_64k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        k_memcpy(buf_b, buf_a, 64000);
+    }
+}
+
+static void run_memset_4k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        k_memset(buf_b, i, 4096);
+    }
+}
+
+static void run_memset_64k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        k_memset(buf_b, i, 64000);
+    }
+}
+
+static void setup_strings(void) {
+    k_memset(buf_a, 'x', 4096);
+    buf_a[4095] = '\0';
+    k_memcpy(buf_b, buf_a, 4096);
+}
+
+static void run_strlen_4k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        sink += k_strlen((char*)buf_a);
+    }
+}
+
+static void run_strcmp_4k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        sink += k_strcmp((char*)buf_a, (char*)buf_b);
+    }
+}
+
+// ---------------------------------------------------------------- memory.c
+
+static void check_memory(void) {
+    init_memory_manager();
+    
+    unsigned char* blocks[256];
+    uint32_t sizes[256];
+    for (int i = 0; i < 256; i++) {
+        sizes[i] = 1 + rng() % 512;
+        blocks[i] = k_malloc(sizes[i]);
+        CHECK(blocks[i] != NULL, "malloc(%u) failed", sizes[i]);
+        k_memset(blocks[i], i, sizes[i]);
+    }
+    
+    // Blocks must not overlap: every byte still holds its block's pattern
+    for (int i = 0; i < 256; i++) {
+        for (uint32_t j = 0; j < sizes[i]; j++) {
+            if (blocks[i][j] != (unsigned char)i) {
+                CHECK(0, "block %d overwritten at %u", i, j);
+                break;
+            }
+        }
+        k_free(blocks[i]);
+    }
+    
+    memory_stats_t stats = get_memory_stats();
+    CHECK(stats.allocation_count == 256, "allocation_count %u", stats.allocation_count);
+    CHECK(stats.free_count == 256, "free_count %u", stats.free_count);
+    CHECK(k_malloc(MEMORY_POOL_SIZE) == NULL, "oversized malloc succeeded");
+}
+
+// Allocator churn: a fixed trace of mixed sizes (mostly small, some pages)
+// over a window of live blocks, freeing a random live block each step
+static void run_malloc_churn(uint32_t ops) {
+    void* live[CHURN_LIVE] = {0};
+    
+    rng_state = 777;
+    init_memory_manager();
+    for (uint32_t i = 0; i < ops; i++) {
+        uint32_t r = rng();
+        uint32_t size = (r & 0xF) == 0 ? 4096 : 16 + (r >> 4) % 240;
+        int slot = rng() % CHURN_LIVE;
+        
+        if (live[slot]) {
+            k_free(live[slot]);
+        }
+        live[slot] = k_malloc(size);
+        if (!live[slot]) {
+            init_memory_manager(); // Pool exhausted, start over
+        }
+    }
+}
+
+// ---------------------------------------------------------------- fs.c
+
+#define FS_NAME_SIZE    16
+static char fs_paths[FS_DIRS * FS_FILES_PER_DIR][2 * FS_NAME_SIZE + 1];  // "/dir/file"
+static char deep_path[FS_DEEP_LEVELS * 4 + 8];
+
+// Root plus FS_DIRS directories holding FS_FILES_PER_DIR files each
+static void setup_fs_wide(void) {
+    fs_init();
+    fs_node_t* root = get_root_directory();
+    for (int d = 0; d < FS_DIRS; d++) {
+        char name[FS_NAME_SIZE];
+        snprintf(name, sizeof(name), "dir%02d", d);
+        fs_mkdir(root, name);
+        
+        char dir_path[32];
+        snprintf(dir_path, sizeof(dir_path), "/%s", name);
+        fs_node_t* dir = fs_find(dir_path);
+        for (int f = 0; f < FS_FILES_PER_DIR && dir; f++) {
+            char file[FS_NAME_SIZE];
+            snprintf(file, sizeof(file), "file%02d.txt", f);
+            fs_create_file(dir, file, "data");
+            snprintf(fs_paths[d * FS_FILES_PER_DIR + f], sizeof(fs_paths[0]), "/%s/%s", name, file);
+        }
+    }
+}
+
+// A chain of FS_DEEP_LEVELS nested directories
+static void setup_fs_deep(void) {
+    fs_init();
+    fs_node_t* dir = get_root_directory();
+    deep_path[0] = '\0';
+    for (int level = 0; level < FS_DEEP_LEVELS && dir; level++) {
+        char name[8];
+        snprintf(name, sizeof(name), "d%02d", level);
+        fs_mkdir(dir, name);
+        k_strcat(deep_path, "/");
+        k_strcat(deep_path, name);
+        dir = fs_find(deep_path);
+    }
+}
+
+// A stand-in for a kernel pipe (pipe.c needs the scheduler): FS_PIPE,
+// length 0, and a read op that hands out pipe_text in small pieces
+static const char pipe_text[] = "piped through cat";
+
+static uint32_t read_fake_pipe(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer) {
+    (void)node;
+    (void)offset;
+    static uint32_t done;
+    uint32_t left = sizeof(pipe_text) - 1 - done;
+    if (size > 5) size = 5;
+    if (size > left) size = left;
+    memcpy(buffer, pipe_text + done, size);
+    done += size;
+    return size;
+}
+
+// Drain a node the way cmd_cat does
+static uint32_t read_all_chunks(fs_node_t* node, char* out, uint32_t capacity) {
+    uint8_t chunk[8];
+    uint32_t offset = 0;
+    for (;;) {
+        uint32_t size = sizeof(chunk);
+        const uint8_t* data = fs_read_chunk(node, offset, chunk, &size);
+        if (size == 0 || offset + size > capacity) break;
+        memcpy(out + offset, data, size);
+        offset += size;
+    }
+    return offset;
+}
+
+static void check_fs_chunks(void) {
+    fs_init();
+    fs_node_t* root = get_root_directory();
+    fs_create_file(root, "chunked.txt", "a file longer than one chunk");
+    char out[64] = {0};
+    uint32_t got = read_all_chunks(fs_find("/chunked.txt"), out, sizeof(out) - 1);
+    CHECK(got == 28 && libc_strcmp(out, "a file longer than one chunk") == 0,
+          "chunked file read %u bytes", got);
+    
+    fs_node_vfs_t pipe;
+    memset(&pipe, 0, sizeof(pipe));
+    pipe.node.flags = FS_PIPE;
+    pipe.read = read_fake_pipe;
+    CHECK(FS_TYPE(&pipe.node) != FS_FILE, "a pipe passes as a file");
+    CHECK(libc_strcmp(fs_get_file_type_string(&pipe.node), "pipe") == 0, "pipe type string");
+    memset(out, 0, sizeof(out));
+    got = read_all_chunks(&pipe.node, out, sizeof(out) - 1);
+    CHECK(got == sizeof(pipe_text) - 1 && libc_strcmp(out, pipe_text) == 0,
+          "chunked pipe read %u bytes", got);
+}
+
+static void check_fs(void) {
+    setup_fs_wide();
+    for (int i = 0; i < FS_DIRS * FS_FILES_PER_DIR; i++) {
+        fs_node_t* node = fs_find(fs_paths[i]);
+        CHECK(node != NULL, "fs_find(%s) missing", fs_paths[i]);
+        if (node) {
+            CHECK(node->flags & FS_FILE, "%s is not a file", fs_paths[i]);
+            char content[8] = {0};
+            CHECK(fs_read(node, 0, sizeof(content) - 1, (uint8_t*)content) == 4 &&
+                  libc_strcmp(content, "data") == 0, "fs_read(%s)", fs_paths[i]);
+            const uint8_t* mapped = fs_map(node, 1, 3);
+            CHECK(mapped && libc_memcmp(mapped, "ata", 3) == 0, "fs_map(%s)", fs_paths[i]);
+            CHECK(fs_map(node, 2, 3) == NULL, "fs_map(%s) past the end", fs_paths[i]);
+        }
+    }
+    CHECK(fs_find("/dir00/missing.txt") == NULL, "missing file found");
+    CHECK(fs_find("/nodir/file00.txt") == NULL, "missing directory found");
+    
+    fs_node_t* dir = fs_find("/dir07");
+    int entries = 0;
+    while (dir && fs_readdir(dir, entries)) {
+        entries++;
+    }
+    CHECK(entries == FS_FILES_PER_DIR, "readdir found %d entries", entries);
+    
+    fs_dir_t* cursor = fs_opendir(dir);
+    fs_dir_entry_t* item;
+    int cursor_entries = 0;
+    while (cursor && (item = fs_readdir_next(cursor))) {
+        CHECK(item->node && item->node->inode == item->entry->inode && item->type == FS_FILE,
+              "cursor entry %s", fs_name(item->entry->name));
+        cursor_entries++;
+    }
+    fs_closedir(cursor);
+    CHECK(cursor_entries == FS_FILES_PER_DIR, "cursor found %d entries", cursor_entries);
+    
+    fs_node_t* first = fs_find(fs_paths[0]);
+    fs_node_t* other = fs_find(fs_paths[FS_FILES_PER_DIR]);
+    CHECK(first && other && first != other && first->name == other->name &&
+          libc_strcmp(fs_name(first->name), "file00.txt") == 0, "interned names shared");
+    
+    fs_stats_t stats = fs_get_stats();
+    CHECK(stats.total_files >= FS_DIRS * FS_FILES_PER_DIR, "fs stats %u files", stats.total_files);
+    
+    setup_fs_deep();
+    fs_node_t* deep = fs_find(deep_path);
+    CHECK(deep != NULL && (deep->flags & FS_DIRECTORY), "deep path %s", deep_path);
+    char relative[sizeof(deep_path) + 8];
+    snprintf(relative, sizeof(relative), "%s/../d%02d", deep_path, FS_DEEP_LEVELS - 1);
+    CHECK(fs_find(relative) == deep, "'..' in %s", relative);
+    
+    // Names up to FS_NAME_MAX fit; the pool is sized for one per node
+    char long_name[FS_NAME_MAX + 2];
+    memset(long_name, 'n', sizeof(long_name) - 1);
+    long_name[FS_NAME_MAX + 1] = '\0';
+    fs_node_t* root = get_root_directory();
+    CHECK(fs_create_file(root, long_name, "") != 0, "name over FS_NAME_MAX accepted");
+    long_name[FS_NAME_MAX] = '\0';
+    char long_path[sizeof(long_name) + 1];
+    snprintf(long_path, sizeof(long_path), "/%s", long_name);
+    CHECK(fs_create_file(root, long_name, "") == 0 && fs_find(long_path), "FS_NAME_MAX name");
+}
+
+static void run_fs_populate(uint32_t ops) {
+    (void)ops;
+    setup_fs_wide();
+}
+
+static void run_fs_find_all(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        sink += (uintptr_t)fs_find(fs_paths[i % (FS_DIRS * FS_FILES_PER_DIR)]);
+    }
+}
+
+static void run_fs_find_deep(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        sink += (uintptr_t)fs_find(deep_path);
+    }
+}
+
+static void run_fs_readdir_scan(uint32_t ops) {
+    fs_node_t* dir = fs_find("/dir00");
+    for (uint32_t i = 0; i < ops; i++) {
+        for (uint32_t index = 0; fs_readdir(dir, index); index++) {
+            sink += index;
+        }
+    }
+}
+
+static void run_fs_readdir_cursor(uint32_t ops) {
+    fs_node_t* dir = fs_find("/dir00");
+    for (uint32_t i = 0; i < ops; i++) {
+        fs_dir_t* cursor = fs_opendir(dir);
+        fs_dir_entry_t* item;
+        while ((item = fs_readdir_next(cursor))) {
+            sink += (uintptr_t)item->node;
+        }
+        fs_closedir(cursor);
+    }
+}
+
+// ---------------------------------------------------------------- main
+
+int main(int argc, char* argv[]) {
+    int run_benchmarks = 1;
+    
+    for (int i = 1; i < argc; i++) {
+        if (libc_strcmp(argv[i], "--check") == 0) {
+            run_benchmarks = 0;
+        } else {
+            filter = argv[i];
+        }
+    }
+    
+    check_string();
+    check_string_sweep();
+    check_memory();
+    check_fs();
+    check_fs_chunks();
+    printf("checks: %s (%d failures)\n", failures ? "FAILED" : "passed", failures);
+    
+    if (run_benchmarks) {
+        printf("\n%-18s %10s %10s %10s   (ns/op over %d runs)\n", "benchmark", "min", "median", "max", BENCH_RUNS);
+        bench("memcpy-64", 100000, NULL, run_memcpy_64);
+        bench("memcpy-4k", 10000, NULL, run_memcpy_4k);
+        bench("memcpy-64k", 1000, NULL, run_memcpy_64k);
+        bench("memset-4k", 10000, NULL, run_memset_4k);
+        bench("memset-64k", 1000, NULL, run_memset_64k);
+        bench("strlen-4k", 10000, setup_strings, run_strlen_4k);
+        bench("strcmp-4k", 10000, setup_strings, run_strcmp_4k);
+        bench("malloc-churn", CHURN_OPS, NULL, run_malloc_churn);
+        bench("fs-populate", 1, NULL, run_fs_populate);
+        bench("fs-find-wide", FS_DIRS * FS_FILES_PER_DIR, setup_fs_wide, run_fs_find_all);
+        bench("fs-find-deep", 1000, setup_fs_deep, run_fs_find_deep);
+        bench("fs-readdir-scan", 100, setup_fs_wide, run_fs_readdir_scan);
+        bench("fs-readdir-cursor", 100, setup_fs_wide, run_fs_readdir_cursor);
+    }
+    
+    return failures ? 1 : 0;
+}
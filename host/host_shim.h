@@ -0,0 +1,29 @@
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+// Forced into every kernel module by the host-bench build (-include).
+// The kernel's string.c and memory.c define the same names as the C
+// library, so they are renamed with a k_ prefix on the host; the kernel
+// headers are reached with -iquote so <string.h> still means libc.
+
+#define strlen      k_strlen
+#define strcmp      k_strcmp
+#define strncmp     k_strncmp
+#define strcpy      k_strcpy
+#define strncpy     k_strncpy
+#define strcat      k_strcat
+#define strchr      k_strchr
+#define strstr      k_strstr
+#define memset      k_memset
+#define memcpy      k_memcpy
+#define memcmp      k_memcmp
+#define malloc      k_malloc
+#define free        k_free
+
+// Host-sized limits: thousands of files and a pool for long churn traces
+#define MAX_FS_NODES        4096
+#define MAX_DIR_ENTRIES     64
+#define MEMORY_POOL_SIZE    (64 * 1024 * 1024)
+#define MEMORY_STATIC_POOL      // No paging on the host: the pool is an array
+
+#endif // HOST_SHIM_H
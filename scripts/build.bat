@@ -1,7 +1,7 @@
 @echo off
 setlocal enabledelayedexpansion
 
-echo GUI-Enabled 32-bit OS Builder (Assembly Only)
+echo GUI-Enabled 32-bit OS Builder
 echo ================================================
 echo.
 
@@ -9,18 +9,25 @@ REM Check if build directory exists, create if not
 if not exist build mkdir build
 
 REM Build bootloader
-echo [1/3] Building GUI bootloader...
+echo [1/4] Building GUI bootloader...
 nasm -f bin src\boot.asm -o build\boot.bin
 if %errorlevel% neq 0 (
     echo Error: Failed to build bootloader
     pause
     exit /b 1
 )
+nasm -f bin src\stage2.asm -o build\stage2.bin
+if %errorlevel% neq 0 (
+    echo Error: Failed to build stage 2 loader
+    pause
+    exit /b 1
+)
 echo ✓ Bootloader built successfully.
 
-REM Build GUI kernel (back to binary format for now)
-echo [2/3] Building GUI kernel...
-nasm -f bin src\kernel.asm -o build\kernel.bin
+REM Build GUI kernel: the assembly entry and helpers linked with the C
+REM kernel (the object list and flags live in the Makefile)
+echo [2/4] Building GUI kernel...
+make build/kernel.bin
 if %errorlevel% neq 0 (
     echo Error: Failed to build GUI kernel
     pause
@@ -28,9 +35,25 @@ if %errorlevel% neq 0 (
 )
 echo ✓ GUI kernel built successfully.
 
+REM Compress kernel behind the self-decompressing stub
+echo [3/4] Packing GUI kernel...
+nasm -f bin src\unpack.asm -o build\unpack.bin
+if %errorlevel% neq 0 (
+    echo Error: Failed to build unpack stub
+    pause
+    exit /b 1
+)
+python scripts\pack_kernel.py build\kernel.bin build\unpack.bin build\kernel.lz4.bin
+if %errorlevel% neq 0 (
+    echo Error: Failed to pack kernel
+    pause
+    exit /b 1
+)
+echo ✓ GUI kernel packed successfully.
+
 REM Create OS image
-echo [3/3] Creating GUI OS image...
-copy /b build\boot.bin + build\kernel.bin build\os.img >nul
+echo [4/4] Creating GUI OS image...
+copy /b build\boot.bin + build\stage2.bin + build\kernel.lz4.bin build\os.img >nul
 if %errorlevel% neq 0 (
     echo Error: Failed to create OS image
     pause
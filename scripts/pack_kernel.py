@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Pack kernel.bin into a self-decompressing LZ4 image.
+
+Usage: pack_kernel.py <kernel.bin> <unpack.bin> <output.bin>
+
+The input is a kernel image starting with the header read by stage2.asm
+(magic, size in sectors, entry point, load address). The output is a new
+image with its own header whose entry point is the unpack.asm stub:
+
+    [header][LZ4 payload][unpack stub][sector padding]
+
+The image is placed as low as possible while still letting the stub decode
+in place: the payload overlaps the end of the decompressed kernel, but the
+output never overtakes input the stub has not read yet.
+"""
+
+import struct
+import sys
+
+KERNEL_MAGIC = 0x534F4353       # 'SCOS'
+HEADER_SIZE = 16
+SECTOR_SIZE = 512
+LOAD_MIN = 0x7E00 + 4 * 512     # End of stage 2
+LOAD_LIMIT = 0x80000            # Must match KERNEL_LOAD_LIMIT in stage2.asm
+PARAMS_OFFSET = 4               # unpack_params in unpack.asm
+
+MIN_MATCH = 4
+LAST_LITERALS = 5               # LZ4: the last 5 bytes are always literals
+MF_LIMIT = 12                   # LZ4: no match may start in the last 12 bytes
+MAX_OFFSET = 0xFFFF
+
+
+def lz4_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def lz4_sequence(out, literals, offset, match_len):
+    lit_len = len(literals)
+    token = min(lit_len, 15) << 4
+    if offset:
+        token |= min(match_len - MIN_MATCH, 15)
+    out.append(token)
+    if lit_len >= 15:
+        lz4_length(out, lit_len - 15)
+    out += literals
+    if offset:
+        out += struct.pack('<H', offset)
+        if match_len - MIN_MATCH >= 15:
+            lz4_length(out, match_len - MIN_MATCH - 15)
+
+
+def lz4_compress(data):
+    """Greedy LZ4 block compressor (hash table of 4-byte prefixes)."""
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    pos = 0
+    match_limit = n - LAST_LITERALS
+
+    while pos < n - MF_LIMIT:
+        key = data[pos:pos + MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = pos
+
+        if candidate is None or pos - candidate > MAX_OFFSET:
+            pos += 1
+            continue
+
+        length = MIN_MATCH
+        while pos + length < match_limit and data[candidate + length] == data[pos + length]:
+            length += 1
+
+        lz4_sequence(out, data[anchor:pos], pos - candidate, length)
+
+        # Index the positions covered by the match for later searches
+        end = pos + length
+        for i in range(pos + 1, min(end, n - MF_LIMIT)):
+            table[data[i:i + MIN_MATCH]] = i
+        pos = end
+        anchor = pos
+
+    lz4_sequence(out, data[anchor:], 0, 0)
+    return bytes(out)
+
+
+def lz4_read_length(buf, ip, length):
+    if length == 15:
+        while True:
+            b = buf[ip]
+            ip += 1
+            length += b
+            if b != 255:
+                break
+    return ip, length
+
+
+def lz4_decode(payload):
+    """Plain decoder, used to check the compressor output."""
+    out = bytearray()
+    ip = 0
+    while True:
+        token = payload[ip]
+        ip, lit_len = lz4_read_length(payload, ip + 1, token >> 4)
+        out += payload[ip:ip + lit_len]
+        ip += lit_len
+        if ip >= len(payload):
+            return bytes(out)
+        offset = payload[ip] | (payload[ip + 1] << 8)
+        ip, match_len = lz4_read_length(payload, ip + 2, token & 0x0F)
+        for _ in range(match_len + MIN_MATCH):
+            out.append(out[-offset])
+
+
+def inplace_distance(payload):
+    """Smallest distance from the output start to the payload start such that
+    decoding in place never writes over input that has not been read yet."""
+    need = 0
+    op = 0
+    ip = 0
+    while True:
+        token = payload[ip]
+        ip, lit_len = lz4_read_length(payload, ip + 1, token >> 4)
+        need = max(need, op - ip)
+        op += lit_len
+        ip += lit_len
+        if ip >= len(payload):
+            return need
+        ip, match_len = lz4_read_length(payload, ip + 2, token & 0x0F)
+        op += match_len + MIN_MATCH
+        need = max(need, op - ip)
+
+
+def main(argv):
+    if len(argv) != 4:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 1
+
+    kernel = open(argv[1], 'rb').read()
+    stub = bytearray(open(argv[2], 'rb').read())
+
+    magic, sectors, entry, dest = struct.unpack_from('<IIII', kernel, 0)
+    if magic != KERNEL_MAGIC:
+        print('pack_kernel: %s has no kernel header' % argv[1], file=sys.stderr)
+        return 1
+    kernel = kernel[:sectors * SECTOR_SIZE]
+
+    payload = lz4_compress(kernel)
+    if lz4_decode(payload) != kernel:
+        print('pack_kernel: LZ4 round trip failed', file=sys.stderr)
+        return 1
+
+    # Lowest paragraph aligned load address that keeps the decode in place safe
+    src = dest + inplace_distance(payload)
+    load = (src - HEADER_SIZE + 0xF) & ~0xF
+    src = load + HEADER_SIZE
+    stub_addr = src + len(payload)
+    struct.pack_into('<IIII', stub, PARAMS_OFFSET, src, len(payload), dest, entry)
+
+    image = bytearray(HEADER_SIZE) + payload + stub
+    image += bytes(-len(image) % SECTOR_SIZE)
+    struct.pack_into('<IIII', image, 0, KERNEL_MAGIC, len(image) // SECTOR_SIZE, stub_addr, load)
+
+    if load < LOAD_MIN or load + len(image) > LOAD_LIMIT:
+        print('pack_kernel: packed image at 0x%X does not fit below 0x%X' % (load, LOAD_LIMIT),
+              file=sys.stderr)
+        return 1
+
+    open(argv[3], 'wb').write(image)
+    print('pack_kernel: %d -> %d bytes (%d -> %d sectors), load 0x%X, unpack to 0x%X' %
+          (len(kernel), len(image), sectors, len(image) // SECTOR_SIZE, load, dest))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
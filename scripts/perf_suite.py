@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""Deterministic boot and command performance suite.
+
+Usage: perf_suite.py [--update] [--qemu PATH | --log FILE] <os.img> <session.txt> <baseline.json>
+
+Boots the image headless in QEMU with -icount (one instruction per virtual
+nanosecond, so the guest TSC follows the instruction count and every run
+executes the same way), talks to the CLI over the serial console and reads
+the kernel's KV records:
+
+    KV event=boot stage=<name> cycles=<n>        (bootlog_report, at boot)
+    KV event=cmd seq=<n> name=<cmd> cycles=<n>   (after every CLI command)
+
+Each boot stage and each session command is compared with the baseline;
+a value more than threshold_pct above it is a regression and the exit
+status is 1. So is a metric missing on either side: a stale baseline
+fails until 'make perf-baseline' records a new one, and a command that
+stopped reporting fails instead of silently dropping out of the check.
+A missing or empty baseline (nothing recorded yet) is reported as SKIP
+and exits 0 without booting anything.
+--update writes the measured values back to the baseline file instead.
+
+--log FILE reads the KV records from a saved serial log (for example the
+output of 'make run-serial') instead of booting QEMU; the image argument
+is then ignored.
+"""
+
+import json
+import queue
+import subprocess
+import sys
+import threading
+import time
+
+BOOT_TIMEOUT = 120          # Seconds of host time
+COMMAND_TIMEOUT = 60
+QEMU_ARGS = [
+    '-icount', 'shift=0,align=off',
+    '-display', 'none',
+    '-serial', 'stdio',
+    '-monitor', 'none',
+    '-no-reboot',
+]
+
+
+def parse_kv(line):
+    """Return (event, fields) for a KV record, else None."""
+    fields = line.split()
+    if len(fields) < 2 or fields[0] != 'KV':
+        return None
+    values = dict(f.split('=', 1) for f in fields[1:] if '=' in f)
+    return values.pop('event', None), values
+
+
+def read_session(path):
+    with open(path) as f:
+        lines = [line.strip() for line in f]
+    return [line for line in lines if line and not line.startswith('#')]
+
+
+class Guest:
+    """QEMU process with a background reader for the serial console."""
+
+    def __init__(self, qemu, image):
+        drive = 'format=raw,file=%s,if=ide,index=0,media=disk' % image
+        self.proc = subprocess.Popen([qemu, '-drive', drive] + QEMU_ARGS,
+                                     stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+        self.lines = queue.Queue()
+        threading.Thread(target=self._reader, daemon=True).start()
+
+    def _reader(self):
+        for raw in self.proc.stdout:
+            self.lines.put(raw.decode('utf-8', 'replace').rstrip('\r\n'))
+        self.lines.put(None)
+
+    def send(self, text):
+        self.proc.stdin.write(text.encode() + b'\r')
+        self.proc.stdin.flush()
+
+    def wait_for(self, event, match, timeout):
+        """Collect records until one of type event satisfies match()."""
+        deadline = time.time() + timeout
+        seen = []
+        while True:
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                raise TimeoutError('no %s record within %ds' % (event, timeout))
+            try:
+                line = self.lines.get(timeout=remaining)
+            except queue.Empty:
+                continue
+            if line is None:
+                raise RuntimeError('QEMU exited')
+            record = parse_kv(line)
+            if record is None:
+                continue
+            seen.append(record)
+            if record[0] == event and match(record[1]):
+                return seen
+
+    def close(self):
+        self.proc.kill()
+        self.proc.wait()
+
+
+def measure(qemu, image, session):
+    guest = Guest(qemu, image)
+    try:
+        boot = {}
+        for kind, fields in guest.wait_for('boot', lambda f: f.get('stage') == 'total', BOOT_TIMEOUT):
+            if kind == 'boot':
+                boot[fields['stage']] = int(fields['cycles'])
+
+        commands = {}
+        for index, command in enumerate(session):
+            guest.send(command)
+            records = guest.wait_for('cmd', lambda f: f.get('seq') == str(index), COMMAND_TIMEOUT)
+            commands['%02d %s' % (index, command)] = int(records[-1][1]['cycles'])
+        return boot, commands
+    finally:
+        guest.close()
+
+
+def measure_log(path, session):
+    """Boot stages and session commands from a saved serial log."""
+    boot = {}
+    commands = {}
+    with open(path, errors='replace') as f:
+        for line in f:
+            record = parse_kv(line.strip())
+            if record is None:
+                continue
+            kind, fields = record
+            if kind == 'boot':
+                boot[fields['stage']] = int(fields['cycles'])
+            elif kind == 'cmd':
+                index = int(fields['seq'])
+                if index < len(session):
+                    commands['%02d %s' % (index, session[index])] = int(fields['cycles'])
+    return boot, commands
+
+
+def compare(kind, measured, baseline, threshold):
+    failures = 0
+    for name in sorted(set(measured) | set(baseline)):
+        value = measured.get(name)
+        base = baseline.get(name)
+        if base is None:
+            status = 'MISSING from baseline'
+            failures += 1
+        elif value is None:
+            status = 'MISSING from run'
+            failures += 1
+        else:
+            change = 100.0 * (value - base) / base if base else 0.0
+            status = '%+.1f%%' % change
+            if value > base * (1 + threshold / 100.0):
+                status += '  REGRESSION'
+                failures += 1
+        print('%-6s %-28s %14s  %s' % (kind, name, '-' if value is None else value, status))
+    return failures
+
+
+def main(argv):
+    args = argv[1:]
+    update = False
+    qemu = 'qemu-system-i386'
+    log = None
+    while args and args[0].startswith('--'):
+        if args[0] == '--update':
+            update = True
+            args = args[1:]
+        elif args[0] == '--qemu' and len(args) > 1:
+            qemu = args[1]
+            args = args[2:]
+        elif args[0] == '--log' and len(args) > 1:
+            log = args[1]
+            args = args[2:]
+        else:
+            break
+    if len(args) != 3:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 1
+    image, session_path, baseline_path = args
+
+    try:
+        with open(baseline_path) as f:
+            baseline = json.load(f)
+    except FileNotFoundError:
+        baseline = {}
+    threshold = baseline.get('threshold_pct', 5)
+    if not update and not baseline.get('boot') and not baseline.get('commands'):
+        print('perf_suite: SKIP - no timings recorded in %s; run make perf-baseline first'
+              % baseline_path)
+        return 0
+
+    session = read_session(session_path)
+    try:
+        if log:
+            boot, commands = measure_log(log, session)
+        else:
+            boot, commands = measure(qemu, image, session)
+    except (TimeoutError, RuntimeError, OSError, KeyError, ValueError) as e:
+        print('perf_suite: %s' % e, file=sys.stderr)
+        return 1
+    if not boot or len(commands) != len(session):
+        print('perf_suite: incomplete run (%d boot stages, %d of %d commands)'
+              % (len(boot), len(commands), len(session)), file=sys.stderr)
+        return 1
+
+    if update:
+        baseline['boot'] = boot
+        baseline['commands'] = commands
+        with open(baseline_path, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('perf_suite: baseline updated (%d boot stages, %d commands)' % (len(boot), len(commands)))
+        return 0
+
+    print('%-6s %-28s %14s  %s (threshold %s%%)' % ('kind', 'metric', 'cycles', 'vs baseline', threshold))
+    failures = compare('boot', boot, baseline.get('boot', {}), threshold)
+    failures += compare('cmd', commands, baseline.get('commands', {}), threshold)
+    if failures:
+        print('perf_suite: %d failure(s)' % failures)
+        return 1
+    print('perf_suite: ok')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
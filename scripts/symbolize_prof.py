@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Symbolize a sampling profiler histogram.
+
+Usage: symbolize_prof.py <symbols> <serial.log> [top]
+
+<symbols> is any of:
+  - the GNU ld map written by the Makefile (build/kernel.map)
+  - `nm` output for an ELF kernel (nm -n kernel.elf > kernel.sym)
+  - a NASM map file ([map symbols kernel.map] in kernel.asm)
+
+<serial.log> is a serial console capture holding the output of the CLI
+`prof dump` command (see prof_dump in src/prof.c):
+
+    PROF-BEGIN hz=<n> samples=<n> dropped=<n>
+    P <eip hex> <count>
+    PROF-END
+
+Each sampled EIP is charged to the closest symbol at or below it, and the
+functions are printed by sample count (the last dump in the capture wins).
+"""
+
+import bisect
+import re
+import sys
+
+DEFAULT_TOP = 25
+
+# "                0x00010020                c_main"  (ld map, symbol line)
+LD_MAP_SYMBOL = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_.$][\w.$]*)\s*$')
+# "00010020 T c_main"  (nm)
+NM_SYMBOL = re.compile(r'^([0-9a-fA-F]+)\s+[TtWw]\s+(\S+)\s*$')
+# "00010020  00010020  c_main"  (NASM map, real and virtual address)
+NASM_SYMBOL = re.compile(r'^([0-9a-fA-F]+)\s+([0-9a-fA-F]+)\s+([A-Za-z_.$][\w.$]*)\s*$')
+
+
+def read_symbols(path):
+    symbols = {}
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            m = LD_MAP_SYMBOL.match(line)
+            if m:
+                name = m.group(2)
+                # Skip linker assignments such as ". = ALIGN(512)"
+                if not name.startswith('.') and '=' not in line:
+                    symbols[int(m.group(1), 16)] = name
+                continue
+            m = NM_SYMBOL.match(line)
+            if m:
+                symbols[int(m.group(1), 16)] = m.group(2)
+                continue
+            m = NASM_SYMBOL.match(line)
+            if m:
+                symbols[int(m.group(2), 16)] = m.group(3)
+    addresses = sorted(symbols)
+    return addresses, [symbols[a] for a in addresses]
+
+
+def read_histogram(path):
+    """Return (header, {eip: count}) for the last complete dump."""
+    result = None
+    current = None
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            fields = line.split()
+            if not fields:
+                continue
+            if fields[0] == 'PROF-BEGIN':
+                header = dict(x.split('=', 1) for x in fields[1:] if '=' in x)
+                current = (header, {})
+            elif fields[0] == 'PROF-END' and current is not None:
+                result = current
+                current = None
+            elif fields[0] == 'P' and current is not None and len(fields) == 3:
+                current[1][int(fields[1], 16)] = int(fields[2])
+    return result
+
+
+def main(argv):
+    if len(argv) not in (3, 4):
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 1
+    top = int(argv[3]) if len(argv) == 4 else DEFAULT_TOP
+
+    addresses, names = read_symbols(argv[1])
+    if not addresses:
+        print('symbolize_prof: no symbols in %s' % argv[1], file=sys.stderr)
+        return 1
+    dump = read_histogram(argv[2])
+    if dump is None:
+        print('symbolize_prof: no complete profile in %s' % argv[2], file=sys.stderr)
+        return 1
+    header, histogram = dump
+
+    functions = {}
+    for eip, count in histogram.items():
+        i = bisect.bisect_right(addresses, eip) - 1
+        name = names[i] if i >= 0 else '0x%08x' % eip
+        functions[name] = functions.get(name, 0) + count
+
+    total = sum(histogram.values())
+    print('%s samples at %s Hz (%s dropped)' %
+          (total, header.get('hz', '?'), header.get('dropped', '?')))
+    print('%8s %6s  %s' % ('samples', '%', 'function'))
+    for name, count in sorted(functions.items(), key=lambda x: -x[1])[:top]:
+        print('%8d %5.1f%%  %s' % (count, 100.0 * count / total, name))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
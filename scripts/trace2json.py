@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Convert a kernel trace dump to Chrome trace JSON.
+
+Usage: trace2json.py [--tsc-mhz N] <serial.log> <trace.json>
+
+The input is a serial console capture (for example from
+`qemu-system-i386 ... -serial file:serial.log`) containing the output of the
+CLI `trace dump` command (see trace_dump in src/trace.c):
+
+    TRACE-BEGIN cpus=<n> events=<n> dropped=<n>
+    T <cpu> <seq> <tsc> <phase> <name> <arg0> <arg1>
+    TRACE-END
+
+Everything else in the capture is ignored; when it holds several dumps the
+last one is used. Timestamps are TSC cycles; --tsc-mhz (default 1000) turns
+them into microseconds. Open the result in chrome://tracing or Perfetto.
+"""
+
+import json
+import sys
+
+DEFAULT_TSC_MHZ = 1000.0
+
+
+def read_dump(lines):
+    """Return (header, events) for the last complete dump in the capture."""
+    dump = None
+    current = None
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == 'TRACE-BEGIN':
+            header = dict(f.split('=', 1) for f in fields[1:] if '=' in f)
+            current = (header, [])
+        elif fields[0] == 'TRACE-END' and current is not None:
+            dump = current
+            current = None
+        elif fields[0] == 'T' and current is not None and len(fields) == 8:
+            cpu, seq, tsc = int(fields[1]), int(fields[2]), int(fields[3])
+            phase, name = fields[4], fields[5]
+            current[1].append((cpu, seq, tsc, phase, name, int(fields[6]), int(fields[7])))
+    return dump
+
+
+def to_chrome(events, tsc_mhz):
+    base = min(e[2] for e in events) if events else 0
+    out = []
+    for cpu, seq, tsc, phase, name, arg0, arg1 in sorted(events, key=lambda e: (e[2], e[1])):
+        event = {
+            'name': name,
+            'ph': phase,
+            'ts': (tsc - base) / tsc_mhz,
+            'pid': 0,
+            'tid': cpu,
+            'args': {'arg0': arg0, 'arg1': arg1, 'seq': seq},
+        }
+        if phase == 'i':
+            event['s'] = 't'    # Instant event scoped to its thread
+        out.append(event)
+    return {'traceEvents': out, 'displayTimeUnit': 'ns'}
+
+
+def main(argv):
+    args = argv[1:]
+    tsc_mhz = DEFAULT_TSC_MHZ
+    if len(args) >= 2 and args[0] == '--tsc-mhz':
+        tsc_mhz = float(args[1])
+        args = args[2:]
+    if len(args) != 2:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 1
+
+    with open(args[0], 'r', errors='replace') as f:
+        dump = read_dump(f)
+    if dump is None:
+        print('trace2json: no complete trace dump in %s' % args[0], file=sys.stderr)
+        return 1
+
+    header, events = dump
+    with open(args[1], 'w') as f:
+        json.dump(to_chrome(events, tsc_mhz), f)
+    print('trace2json: %d events (%s dropped) -> %s' %
+          (len(events), header.get('dropped', '?'), args[1]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
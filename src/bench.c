@@ -0,0 +1,308 @@
+#include "bench.h"
+#include "cpu.h"
+#include "string.h"
+#include "memory.h"
+#include "fs.h"
+#include "gui.h"
+#include "trace.h"
+#include "serial.h"
+#include "syscall.h"
+#include "task.h"
+#include "channel.h"
+#include "compositor.h"
+#include "cursor.h"
+#include "interrupts.h"
+
+#define BENCH_BUFFER_SIZE   (SCREEN_WIDTH * SCREEN_HEIGHT)
+#define BENCH_DEEP_PATH     "/.bench/a/b/c/d/e/f/leaf"
+
+// Shared buffers
+static unsigned char bench_src[BENCH_BUFFER_SIZE];
+static unsigned char bench_dst[BENCH_BUFFER_SIZE];
+
+// 8bpp back buffer the size of the screen, allocated on first use
+static surface_t bench_back;
+
+// Keeps results observable so the loops are not optimized away
+static volatile uint32_t bench_sink;
+
+static void bench_memcpy_64(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        memcpy(bench_dst, bench_src, 64);
+    }
+}
+
+static void bench_memcpy_4k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        memcpy(bench_dst, bench_src, 4096);
+    }
+}
+
+static void bench_memcpy_screen(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        memcpy(bench_dst, bench_src, BENCH_BUFFER_SIZE);
+    }
+}
+
+static void bench_memset_64(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        memset(bench_dst, i, 64);
+    }
+}
+
+static void bench_memset_4k(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        memset(bench_dst, i, 4096);
+    }
+}
+
+static void bench_memset_screen(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        memset(bench_dst, i, BENCH_BUFFER_SIZE);
+    }
+}
+
+// Allocate a mix of sizes and free them again. The pool allocator never
+// reuses memory, so op counts are kept small to bound what each run uses.
+static void bench_malloc_free(uint32_t ops) {
+    static const uint32_t sizes[4] = {16, 48, 24, 96};
+    void* blocks[4];
+    
+    for (uint32_t i = 0; i < ops; i += 4) {
+        for (int j = 0; j < 4; j++) {
+            blocks[j] = malloc(sizes[j]);
+        }
+        for (int j = 0; j < 4; j++) {
+            free(blocks[j]);
+        }
+    }
+}
+
+// Build BENCH_DEEP_PATH (directories .bench/a-f plus a leaf file) on the
+// first run only. Nodes are never freed, so later runs reuse the fixture
+// and a failed build is not retried; ls (without -a) and tree hide dot names
+static void bench_fs_setup(void) {
+    static char* parts[] = {".bench", "a", "b", "c", "d", "e", "f"};
+    static int built;
+    char path[64] = "";
+    fs_node_t* dir = get_root_directory();
+    
+    if (built) {
+        return;
+    }
+    built = 1;
+    
+    for (int i = 0; i < (int)(sizeof(parts) / sizeof(parts[0])) && dir; i++) {
+        strcat(path, "/");
+        strcat(path, parts[i]);
+        fs_mkdir(dir, parts[i]);
+        dir = fs_find(path);
+    }
+    if (dir) {
+        fs_create_file(dir, "leaf", "");
+    }
+}
+
+static void bench_fs_find_deep(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        bench_sink += (uint32_t)fs_find(BENCH_DEEP_PATH);
+    }
+}
+
+static void bench_fs_find_shallow(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        bench_sink += (uint32_t)fs_find("/readme.txt");
+    }
+}
+
+static void bench_draw_text(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        draw_text(8, 8, "The quick brown fox jumps over", COLOR_WHITE);
+    }
+}
+
+static void bench_clear(uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        gui_clear_framebuffer(i & 1 ? COLOR_BLACK : COLOR_CYAN);
+    }
+}
+
+static void bench_present_setup(void) {
+    surface_t* screen = gui_screen_surface();
+    if (!bench_back.pixels) {
+        uint8_t* pixels = malloc(screen->width * screen->height);
+        if (pixels) {
+            surface_init(&bench_back, pixels, screen->width, screen->height,
+                         screen->width, SURFACE_8BPP);
+        }
+    }
+}
+
+// Copy a whole-screen 8bpp frame to the display, as gui_present() does
+// for a SCREEN_WIDTH x SCREEN_HEIGHT one
+static void bench_present(uint32_t ops) {
+    if (!bench_back.pixels) {
+        return;
+    }
+    
+    surface_t* screen = gui_screen_surface();
+    for (uint32_t i = 0; i < ops; i++) {
+        surface_blit(screen, 0, 0, &bench_back, 0, 0, bench_back.width, bench_back.height);
+    }
+}
+
+// Null system call round trips from ring 3; the single ring 3 entry and
+// SYS_EXIT per run are spread over all ops
+static void bench_syscall_int80(uint32_t ops) {
+    syscall_run_user((uint32_t)(uintptr_t)user_bench_int80, ops);
+}
+
+// Falls back to int 0x80 on CPUs without SEP
+static void bench_syscall_sysenter(uint32_t ops) {
+    void (*loop)(void) = syscall_has_sysenter() ? user_bench_sysenter : user_bench_int80;
+    syscall_run_user((uint32_t)(uintptr_t)loop, ops);
+}
+
+#define BENCH_MESSAGE_SIZE  4096
+#define BENCH_CHANNEL_SIZE  (16 * BENCH_MESSAGE_SIZE)
+
+static channel_t* bench_channel;
+
+// Writes arg messages straight into the ring
+static void bench_channel_producer(void* arg) {
+    uint32_t ops = (uint32_t)(uintptr_t)arg;
+    for (uint32_t i = 0; i < ops; i++) {
+        uint8_t* message = channel_write_begin(bench_channel, BENCH_MESSAGE_SIZE);
+        memset(message, i, BENCH_MESSAGE_SIZE);
+        channel_write_end(bench_channel, BENCH_MESSAGE_SIZE);
+    }
+}
+
+static void bench_channel_setup(void) {
+    if (!bench_channel) {
+        bench_channel = channel_create(BENCH_CHANNEL_SIZE);
+    }
+}
+
+// A producer task fills 4KB messages in place, this task consumes them
+// in place; the cost is the ring and the task switches, no copies
+static void bench_channel_4k(uint32_t ops) {
+    if (!bench_channel || task_create("bench producer", bench_channel_producer, (void*)(uintptr_t)ops) < 0) {
+        return;
+    }
+    
+    uint32_t total = ops * BENCH_MESSAGE_SIZE;
+    for (uint32_t received = 0; received < total;) {
+        uint32_t available;
+        uint8_t* data = channel_read_begin(bench_channel, &available);
+        bench_sink += data[0] + data[available - 1];
+        channel_read_end(bench_channel, available);
+        received += available;
+    }
+}
+
+static const bench_t benches[] = {
+    {"memcpy-64", "memcpy 64 bytes", 256, 0, bench_memcpy_64},
+    {"memcpy-4k", "memcpy 4KB", 32, 0, bench_memcpy_4k},
+    {"memcpy-64k", "memcpy 64000 bytes", 4, 0, bench_memcpy_screen},
+    {"memset-64", "memset 64 bytes", 256, 0, bench_memset_64},
+    {"memset-4k", "memset 4KB", 32, 0, bench_memset_4k},
+    {"memset-64k", "memset 64000 bytes", 4, 0, bench_memset_screen},
+    {"malloc-free", "malloc/free mixed sizes", 16, 0, bench_malloc_free},
+    {"fs-find-deep", "fs_find on an 8-level path", 16, bench_fs_setup, bench_fs_find_deep},
+    {"fs-find", "fs_find on a root file", 16, 0, bench_fs_find_shallow},
+    {"draw-text", "draw_text 30 characters", 4, 0, bench_draw_text, BENCH_SCREEN},
+    {"clear", "Full-screen clear", 2, 0, bench_clear, BENCH_SCREEN},
+    {"present", "Full-screen present", 2, bench_present_setup, bench_present, BENCH_SCREEN},
+    {"sys-int80", "Null syscall via int 0x80", 256, 0, bench_syscall_int80},
+    {"sys-sysenter", "Null syscall via sysenter", 256, 0, bench_syscall_sysenter},
+    {"chan-4k", "4KB messages through a channel", 64, bench_channel_setup, bench_channel_4k},
+};
+
+#define BENCH_COUNT ((int)(sizeof(benches) / sizeof(benches[0])))
+
+int bench_count(void) {
+    return BENCH_COUNT;
+}
+
+const bench_t* bench_get(int index) {
+    if (index < 0 || index >= BENCH_COUNT) {
+        return 0;
+    }
+    return &benches[index];
+}
+
+const bench_t* bench_find(const char* name) {
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        if (strcmp(benches[i].name, name) == 0) {
+            return &benches[i];
+        }
+    }
+    return 0;
+}
+
+// Time one run with every IRQ line masked, in cycles per operation.
+// Masking at the PIC rather than clearing IF keeps the interrupt state the
+// same for kernel benchmarks and the ring 3 ones, which always run with IF
+// set
+static uint32_t bench_time(const bench_t* bench) {
+    uint16_t masks = irq_mask_all();
+    uint64_t start = cpu_rdtsc();
+    bench->run(bench->ops);
+    uint64_t cycles = cpu_rdtsc() - start;
+    irq_mask_restore(masks);
+    
+    // Runs are sized to stay well below 2^32 cycles (no 64-bit divide)
+    uint32_t total = cycles > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)cycles;
+    return total / bench->ops;
+}
+
+// Run a benchmark BENCH_RUNS times after one warm-up run and report
+// min/median/max; also logged to serial as a "bench" key=value record
+void bench_run(const bench_t* bench, bench_result_t* result) {
+    uint32_t runs[BENCH_RUNS];
+    
+    // Trace points would be timed along with the work
+    int tracing = trace_is_enabled();
+    trace_enable(0);
+    
+    // Screen benchmarks draw under the pointer and over the windows
+    int cursor = (bench->flags & BENCH_SCREEN) ? cursor_hide() : 0;
+    
+    if (bench->setup) {
+        bench->setup();
+    }
+    bench_time(bench);
+    
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        uint32_t value = bench_time(bench);
+        
+        // Insertion sort as we go
+        int pos = i;
+        while (pos > 0 && runs[pos - 1] > value) {
+            runs[pos] = runs[pos - 1];
+            pos--;
+        }
+        runs[pos] = value;
+    }
+    
+    trace_enable(tracing);
+    
+    // Recompose what the screen benchmarks drew over before the pointer
+    // saves the pixels under it again
+    if (bench->flags & BENCH_SCREEN) {
+        surface_t* screen = gui_screen_surface();
+        compositor_damage_screen(0, 0, screen->width, screen->height);
+        compositor_flush();
+    }
+    if (cursor) cursor_show();
+    
+    result->bench = bench;
+    result->min = runs[0];
+    result->median = runs[BENCH_RUNS / 2];
+    result->max = runs[BENCH_RUNS - 1];
+    
+    serial_kv("bench", "name=%s ops=%u runs=%d min=%u median=%u max=%u",
+              bench->name, bench->ops, BENCH_RUNS,
+              result->min, result->median, result->max);
+}
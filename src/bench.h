@@ -0,0 +1,36 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+// Every benchmark is timed BENCH_RUNS times; results are per operation
+#define BENCH_RUNS 15
+
+// bench_t flags
+#define BENCH_SCREEN 0x1        // Draws to the screen; recomposed afterwards
+
+// One microbenchmark: run() performs ops operations
+typedef struct {
+    const char* name;
+    const char* description;
+    uint32_t ops;
+    void (*setup)(void);        // Optional, called once before the runs
+    void (*run)(uint32_t ops);
+    uint32_t flags;             // BENCH_*
+} bench_t;
+
+// TSC cycles per operation over BENCH_RUNS runs
+typedef struct {
+    const bench_t* bench;
+    uint32_t min;
+    uint32_t median;
+    uint32_t max;
+} bench_result_t;
+
+// Benchmark functions
+int bench_count(void);
+const bench_t* bench_get(int index);
+const bench_t* bench_find(const char* name);
+void bench_run(const bench_t* bench, bench_result_t* result);
+
+#endif // BENCH_H
@@ -0,0 +1,71 @@
+#include "bootlog.h"
+#include "cpu.h"
+#include "serial.h"
+
+static bootlog_stage_t stages[BOOTLOG_MAX_STAGES];
+static int stage_count = 0;
+
+static int add_stage(const char* name, uint64_t start, uint64_t end) {
+    if (stage_count >= BOOTLOG_MAX_STAGES) {
+        return -1;
+    }
+    stages[stage_count].name = name;
+    stages[stage_count].start = start;
+    stages[stage_count].end = end;
+    return stage_count++;
+}
+
+// Start the log, importing the bootloader timestamps if present
+void bootlog_init(void) {
+    uint64_t now = cpu_rdtsc();
+    const volatile boot_info_t* info = boot_info();
+
+    stage_count = 0;
+
+    if (info->magic == BOOT_INFO_MAGIC) {
+        add_stage("stage1", info->tsc_stage1, info->tsc_stage2);
+        add_stage("kernel-load", info->tsc_stage2, info->tsc_loaded);
+        add_stage("pmode-setup", info->tsc_loaded, info->tsc_kernel);
+        add_stage("kernel-entry", info->tsc_kernel, now);
+    }
+}
+
+// Open a stage; returns its handle for bootlog_end (or -1 when full)
+int bootlog_begin(const char* name) {
+    uint64_t now = cpu_rdtsc();
+    return add_stage(name, now, now);
+}
+
+void bootlog_end(int stage) {
+    if (stage >= 0 && stage < stage_count) {
+        stages[stage].end = cpu_rdtsc();
+    }
+}
+
+int bootlog_count(void) {
+    return stage_count;
+}
+
+const bootlog_stage_t* bootlog_get(int index) {
+    if (index < 0 || index >= stage_count) {
+        return 0;
+    }
+    return &stages[index];
+}
+
+// Cycles from the first recorded timestamp to the end of the last stage
+uint64_t bootlog_total(void) {
+    if (stage_count == 0) {
+        return 0;
+    }
+    return stages[stage_count - 1].end - stages[0].start;
+}
+
+// Emit every stage as a serial key=value record for scripted boot timing
+void bootlog_report(void) {
+    for (int i = 0; i < stage_count; i++) {
+        serial_kv("boot", "stage=%s cycles=%llu", stages[i].name,
+                  stages[i].end - stages[i].start);
+    }
+    serial_kv("boot", "stage=total cycles=%llu", bootlog_total());
+}
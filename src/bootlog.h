@@ -0,0 +1,53 @@
+#ifndef BOOTLOG_H
+#define BOOTLOG_H
+
+#include <stdint.h>
+
+// Boot information block filled in by the bootloader (see stage2.asm)
+#define BOOT_INFO_ADDR  0x500
+#define BOOT_INFO_MAGIC 0x544F4F42 // 'BOOT'
+
+typedef struct {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t tsc_stage1;    // Boot sector entry
+    uint64_t tsc_stage2;    // Stage 2 entry
+    uint64_t tsc_loaded;    // Kernel image loaded
+    uint64_t tsc_kernel;    // Jump to the kernel
+    uint32_t fb_addr;       // Framebuffer set up by stage 2 (0xA0000 in mode 13h)
+    uint32_t fb_pitch;      // Bytes per row
+    uint16_t fb_width;
+    uint16_t fb_height;
+    uint8_t fb_bpp;         // 8 (mode 13h) or 32 (VBE linear framebuffer)
+    uint8_t fb_reserved[3];
+} __attribute__((packed)) boot_info_t;
+
+// The block at its fixed address. The asm hides the constant from the
+// compiler, which would otherwise treat the cast as a zero-sized object
+// (-Warray-bounds); volatile because the bootloader wrote it
+static inline const volatile boot_info_t* boot_info(void) {
+    uintptr_t address = BOOT_INFO_ADDR;
+    asm("" : "+r"(address));
+    return (const volatile boot_info_t*)address;
+}
+
+// Boot log limits
+#define BOOTLOG_MAX_STAGES 16
+
+// One timed boot stage (TSC timestamps)
+typedef struct {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+} bootlog_stage_t;
+
+// Boot log functions
+void bootlog_init(void);
+int bootlog_begin(const char* name);
+void bootlog_end(int stage);
+int bootlog_count(void);
+const bootlog_stage_t* bootlog_get(int index);
+uint64_t bootlog_total(void);
+void bootlog_report(void);
+
+#endif // BOOTLOG_H
@@ -0,0 +1,124 @@
+#include "channel.h"
+#include "task.h"
+
+static channel_t channels[CHANNEL_MAX];
+
+// Unmap the window and free its frames (the second ring view shares the
+// first one's). The pages were mapped here rather than by faults, so
+// they are unmapped here too before the region goes
+static void channel_unmap(channel_t* channel, uint32_t ring) {
+    uint32_t base = channel->region->start;
+    for (uint32_t offset = 0; offset < PAGE_SIZE + 2 * ring; offset += PAGE_SIZE) {
+        uint32_t frame = paging_unmap(base + offset);
+        if (frame && offset < PAGE_SIZE + ring) paging_free_frame(frame);
+    }
+    paging_release(channel->region);
+    channel->region = 0;
+}
+
+// size is rounded up to a power of two pages
+channel_t* channel_create(uint32_t size) {
+    if (size == 0 || size > CHANNEL_MAX_SIZE) return 0;
+    uint32_t ring = PAGE_SIZE;
+    while (ring < size) ring <<= 1;
+    
+    int slot = 0;
+    while (slot < CHANNEL_MAX && channels[slot].region) slot++;
+    if (slot == CHANNEL_MAX) return 0;
+    
+    // VM_SHARED: the frames belong to the channel, not the region
+    channel_t* channel = &channels[slot];
+    uint32_t base = PAGING_CHANNEL_BASE + slot * CHANNEL_WINDOW;
+    channel->region = paging_reserve(base, PAGE_SIZE + 2 * ring, PAGE_WRITE | VM_SHARED,
+                                     "channel", 0, 0);
+    if (!channel->region) return 0;
+    
+    // On failure channel_unmap() takes down whatever both views have so
+    // far, including a frame mapped only in the first one
+    int failed = 0;
+    for (uint32_t mapped = 0; mapped < PAGE_SIZE + ring && !failed; mapped += PAGE_SIZE) {
+        uint32_t frame = paging_alloc_frame();
+        if (!frame || paging_map(base + mapped, frame, PAGE_WRITE) != 0) {
+            if (frame) paging_free_frame(frame);
+            failed = 1;
+        } else if (mapped >= PAGE_SIZE &&
+                   paging_map(base + mapped + ring, frame, PAGE_WRITE) != 0) {
+            failed = 1;
+        }
+    }
+    if (failed) {
+        channel_unmap(channel, ring);
+        return 0;
+    }
+    
+    channel->header = (channel_header_t*)(uintptr_t)base;
+    channel->data = (uint8_t*)(uintptr_t)(base + PAGE_SIZE);
+    channel->header->head = 0;
+    channel->header->tail = 0;
+    channel->header->size = ring;
+    channel->header->readers_waiting = 0;
+    channel->header->writers_waiting = 0;
+    channel->header->closed = 0;
+    return channel;
+}
+
+void channel_destroy(channel_t* channel) {
+    channel_close(channel);
+    channel_unmap(channel, channel->header->size);
+}
+
+// Space for length contiguous bytes, waiting while the ring is too full;
+// 0 if the channel is closed or length exceeds the ring
+void* channel_write_begin(channel_t* channel, uint32_t length) {
+    channel_header_t* header = channel->header;
+    if (length > header->size) return 0;
+    
+    while (!header->closed && header->size - (header->head - header->tail) < length) {
+        uint32_t tail = header->tail;
+        header->writers_waiting++;
+        futex_wait(&header->tail, tail);
+        header->writers_waiting--;
+    }
+    if (header->closed) return 0;
+    return channel->data + (header->head & (header->size - 1));
+}
+
+void channel_write_end(channel_t* channel, uint32_t length) {
+    channel_header_t* header = channel->header;
+    header->head += length;
+    if (header->readers_waiting) {
+        futex_wake(&header->head, header->readers_waiting);
+    }
+}
+
+// Everything written and not yet read, contiguous; waits while the ring
+// is empty. Returns 0 once the channel is closed and drained
+void* channel_read_begin(channel_t* channel, uint32_t* available) {
+    channel_header_t* header = channel->header;
+    while (header->head == header->tail && !header->closed) {
+        uint32_t head = header->head;
+        header->readers_waiting++;
+        futex_wait(&header->head, head);
+        header->readers_waiting--;
+    }
+    
+    *available = header->head - header->tail;
+    if (*available == 0) return 0;
+    return channel->data + (header->tail & (header->size - 1));
+}
+
+void channel_read_end(channel_t* channel, uint32_t length) {
+    channel_header_t* header = channel->header;
+    header->tail += length;
+    if (header->writers_waiting) {
+        futex_wake(&header->tail, header->writers_waiting);
+    }
+}
+
+// Readers drain what is left, writers fail from now on
+void channel_close(channel_t* channel) {
+    channel_header_t* header = channel->header;
+    header->closed = 1;
+    futex_wake(&header->head, TASK_MAX);
+    futex_wake(&header->tail, TASK_MAX);
+}
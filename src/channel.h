@@ -0,0 +1,44 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdint.h>
+#include "paging.h"
+
+// Shared-memory ring channels between tasks. The ring's frames are
+// mapped twice back to back, so any span of up to the ring size is
+// contiguous in memory and both ends work on the ring in place
+#define CHANNEL_MAX         8
+#define CHANNEL_MAX_SIZE    (512 * 1024)
+#define CHANNEL_WINDOW      (2 * 1024 * 1024)   // Header page + two ring views
+
+// Control block, in the channel's first shared page. head and tail count
+// bytes written and read since creation (they wrap freely)
+typedef struct {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t size;                      // Ring bytes, a power of two
+    volatile uint32_t readers_waiting;  // Wakes are skipped when zero
+    volatile uint32_t writers_waiting;
+    volatile uint32_t closed;
+} channel_header_t;
+
+typedef struct {
+    channel_header_t* header;
+    uint8_t* data;
+    vm_region_t* region;                // Mapped window, 0 when unused
+} channel_t;
+
+// Channel functions
+// A writer asks channel_write_begin() for space, fills it in place and
+// publishes it with channel_write_end(); a reader takes what
+// channel_read_begin() offers and releases it with channel_read_end().
+// Both block (futex_wait) only when the ring is full or empty
+channel_t* channel_create(uint32_t size);
+void channel_destroy(channel_t* channel);
+void* channel_write_begin(channel_t* channel, uint32_t length);
+void channel_write_end(channel_t* channel, uint32_t length);
+void* channel_read_begin(channel_t* channel, uint32_t* available);
+void channel_read_end(channel_t* channel, uint32_t length);
+void channel_close(channel_t* channel);
+
+#endif // CHANNEL_H
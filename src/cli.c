@@ -3,6 +3,20 @@
 #include "gui.h"
 #include "string.h"
 #include "memory.h"
+#include "bootlog.h"
+#include "kprintf.h"
+#include "serial.h"
+#include "trace.h"
+#include "prof.h"
+#include "bench.h"
+#include "cpu.h"
+#include "compositor.h"
+#include "frame.h"
+#include "paging.h"
+#include "elf.h"
+#include "syscall.h"
+#include "task.h"
+#include "pipe.h"
 
 // CLI state
 cli_state_t cli;
@@ -18,10 +32,28 @@ static int output_pos = 0;
 #define CLI_TEXT_ROWS 20
 #define CLI_TEXT_COLS 35
 
+// Pipelines: each stage of "a | b | c" runs as a task whose output (and
+// input, after the first) is a pipe; the last stage writes to the window
+#define CLI_MAX_STAGES 4
+#define CLI_LINE_MAX 256
+
+typedef struct {
+    fs_node_t* in;
+    fs_node_t* out;
+} cli_stage_io_t;
+
+static cli_stage_io_t stage_io[TASK_MAX];   // Indexed by task
+static volatile uint32_t stages_running = 0;
+
+// CLI window and its backing store; redrawn only when cli_dirty is set
+static uint8_t cli_pixels[CLI_WIDTH * CLI_HEIGHT];
+static window_t cli_window;
+static int cli_dirty = 0;
+
 // Command table
 static cli_command_t commands[] = {
     {"help", "Show available commands", cmd_help},
-    {"ls", "List directory contents", cmd_ls},
+    {"ls", "List directory contents (ls [-a] [dir])", cmd_ls},
     {"cat", "Display file contents", cmd_cat},
     {"cd", "Change directory", cmd_cd},
     {"pwd", "Print working directory", cmd_pwd},
@@ -32,6 +64,14 @@ static cli_command_t commands[] = {
     {"tree", "Show directory tree", cmd_tree},
     {"stat", "Show file/directory info", cmd_stat},
     {"mem", "Show memory information", cmd_mem},
+    {"bootlog", "Show boot stage timings", cmd_bootlog},
+    {"trace", "Kernel trace (on/off/clear/dump)", cmd_trace},
+    {"prof", "Sampling profiler (start/stop/top/dump)", cmd_prof},
+    {"bench", "Run microbenchmarks (bench [list|name])", cmd_bench},
+    {"fps", "Frame times and pacing (fps [reset])", cmd_fps},
+    {"run", "Run an ELF program (run <file>)", cmd_run},
+    {"grep", "Print lines containing text", cmd_grep},
+    {"wc", "Count lines, words and bytes", cmd_wc},
     {"exit", "Exit CLI mode", cmd_exit},
     {"", "", NULL} // Terminator
 };
@@ -44,21 +84,57 @@ void cli_init() {
     output_pos = 0;
     memset(output_buffer, 0, sizeof(output_buffer));
     strcpy(cli.current_path, "/");
+    window_init(&cli_window, cli_pixels, CLI_X, CLI_Y, CLI_WIDTH, CLI_HEIGHT);
+    
+    // Kernel messages (kprintf) go to the CLI output
+    kprintf_set_console(cli_write);
 }
 
 void cli_clear_screen() {
     output_pos = 0;
     memset(output_buffer, 0, sizeof(output_buffer));
     cli_scroll_offset = 0;
+    cli_dirty = 1;
 }
 
-void cli_print(char* text) {
-    if (!text) return;
+// Append to the output buffer and tee to the serial console; inside a
+// pipeline stage the text goes down the stage's pipe instead
+void cli_write(const char* text, size_t len) {
+    fs_node_t* out = stage_io[task_current()].out;
+    if (out) {
+        fs_write(out, 0, len, (uint8_t*)text);
+        return;
+    }
     
-    int len = strlen(text);
+    serial_write(text, len);
+    cli_dirty = 1;
     if (output_pos + len < sizeof(output_buffer) - 1) {
-        strcpy(output_buffer + output_pos, text);
+        memcpy(output_buffer + output_pos, text, len);
         output_pos += len;
+        output_buffer[output_pos] = '\0';
+    }
+}
+
+void cli_print(char* text) {
+    if (!text) return;
+    cli_write(text, strlen(text));
+}
+
+// Format through a small stack buffer flushed to cli_write, so the serial
+// copy is complete even when the screen buffer is full
+void cli_printf(const char* fmt, ...) {
+    char buf[128];
+    strbuf_t sb;
+    strbuf_init(&sb, buf, sizeof(buf));
+    sb.flush = cli_write;
+    
+    va_list args;
+    va_start(args, fmt);
+    strbuf_vprintf(&sb, fmt, args);
+    va_end(args);
+    
+    if (sb.len > 0) {
+        cli_write(sb.buf, sb.len);
     }
 }
 
@@ -81,17 +157,22 @@ void cli_prompt() {
     cli_print("$ ");
 }
 
+// Render into the window's backing store (window coordinates); the
+// compositor copies the visible parts to the screen
 void cli_draw() {
+    trace_event(TRACE_CLI_DRAW_BEGIN, 0, 0);
+    surface_t* previous = gui_set_target(&cli_window.surface);
+    
     // Draw CLI window background
-    draw_filled_rectangle(CLI_X, CLI_Y, CLI_WIDTH, CLI_HEIGHT, COLOR_BLACK);
-    draw_rectangle(CLI_X, CLI_Y, CLI_WIDTH, CLI_HEIGHT, COLOR_WHITE);
+    draw_filled_rectangle(0, 0, CLI_WIDTH, CLI_HEIGHT, COLOR_BLACK);
+    draw_rectangle(0, 0, CLI_WIDTH, CLI_HEIGHT, COLOR_WHITE);
     
     // Draw title bar
-    draw_filled_rectangle(CLI_X + 1, CLI_Y + 1, CLI_WIDTH - 2, 15, COLOR_DARK_GRAY);
-    draw_text(CLI_X + 5, CLI_Y + 5, "ScooterOS Command Line Interface", COLOR_WHITE);
+    draw_filled_rectangle(1, 1, CLI_WIDTH - 2, 15, COLOR_DARK_GRAY);
+    draw_text(5, 5, "ScooterOS Command Line Interface", COLOR_WHITE);
     
     // Draw output text
-    int y = CLI_Y + 20;
+    int y = 20;
     int line_height = 9;
     int max_lines = (CLI_HEIGHT - 40) / line_height;
     
@@ -110,7 +191,7 @@ void cli_draw() {
             strncpy(line_buffer, line_start, line_len);
             line_buffer[line_len] = '\0';
             
-            draw_text(CLI_X + 5, y + line_count * line_height, line_buffer, COLOR_WHITE);
+            draw_text(5, y + line_count * line_height, line_buffer, COLOR_WHITE);
             
             if (*current == '\n') {
                 current++;
@@ -123,20 +204,25 @@ void cli_draw() {
     }
     
     // Draw current command line
-    int prompt_y = CLI_Y + CLI_HEIGHT - 25;
-    draw_text(CLI_X + 5, prompt_y, cli.current_path, COLOR_YELLOW);
+    int prompt_y = CLI_HEIGHT - 25;
+    draw_text(5, prompt_y, cli.current_path, COLOR_YELLOW);
     
     char prompt_buffer[256];
-    strcpy(prompt_buffer, cli.current_path);
-    strcat(prompt_buffer, "$ ");
-    strcat(prompt_buffer, cli.buffer);
+    strbuf_t prompt;
+    strbuf_init(&prompt, prompt_buffer, sizeof(prompt_buffer));
+    strbuf_printf(&prompt, "%s$ ", cli.current_path);
+    int prompt_len = prompt.len;
+    strbuf_puts(&prompt, cli.buffer);
     
-    int prompt_len = strlen(cli.current_path) + 2;
-    draw_text(CLI_X + 5, prompt_y + 10, prompt_buffer, COLOR_WHITE);
+    draw_text(5, prompt_y + 10, prompt_buffer, COLOR_WHITE);
     
     // Draw cursor
-    int cursor_x = CLI_X + 5 + (prompt_len + cli.buffer_pos) * 8;
+    int cursor_x = 5 + (prompt_len + cli.buffer_pos) * 8;
     draw_filled_rectangle(cursor_x, prompt_y + 10, 8, 8, COLOR_WHITE);
+    
+    gui_set_target(previous);
+    compositor_damage(&cli_window, 0, 0, CLI_WIDTH, CLI_HEIGHT);
+    trace_event(TRACE_CLI_DRAW_END, 0, 0);
 }
 
 void cli_toggle() {
@@ -146,6 +232,12 @@ void cli_toggle() {
         cli_println("ScooterOS Command Line Interface v1.0");
         cli_println("Type 'help' for available commands.");
         cli_println("");
+        compositor_map(&cli_window);
+    } else {
+        // Whatever the window covered is recomposed from below it
+        frame_begin();
+        compositor_unmap(&cli_window);
+        frame_present();
     }
 }
 
@@ -180,21 +272,10 @@ cli_command_t* cli_find_command(char* name) {
     return NULL;
 }
 
-void cli_handle_input(char* input) {
-    if (!input || strlen(input) == 0) {
-        return;
-    }
-    
-    // Add to history
-    if (cli.history_count < CLI_HISTORY_SIZE) {
-        strcpy(cli.history[cli.history_count], input);
-        cli.history_count++;
-    }
-    
-    // Parse command
+static void cli_run_command(char* line) {
     char* argv[CLI_MAX_ARGS];
     int argc;
-    cli_parse_command(input, argv, &argc);
+    cli_parse_command(line, argv, &argc);
     
     if (argc == 0) return;
     
@@ -207,27 +288,162 @@ void cli_handle_input(char* input) {
         cli_print(argv[0]);
         cli_println(". Type 'help' for available commands.");
     }
+}
+
+// Split "a | b | c" in place; returns the number of stages, -1 if there
+// are too many
+static int cli_split_pipeline(char* input, char* stages[]) {
+    int count = 0;
+    char* stage = input;
+    for (;;) {
+        if (count == CLI_MAX_STAGES) return -1;
+        stages[count++] = stage;
+        
+        char* bar = strchr(stage, '|');
+        if (!bar) return count;
+        *bar = '\0';
+        stage = bar + 1;
+    }
+}
+
+// Runs one stage, then closes its pipe ends so its neighbours see end of
+// input (or a closed reader)
+static void cli_stage_main(void* arg) {
+    cli_run_command((char*)arg);
+    
+    cli_stage_io_t* io = &stage_io[task_current()];
+    if (io->out) pipe_close(io->out, PIPE_WRITE_END);
+    if (io->in) pipe_close(io->in, PIPE_READ_END);
+    io->in = NULL;
+    io->out = NULL;
+    
+    stages_running--;
+    futex_wake(&stages_running, 1);
+}
+
+// Stages run concurrently and exchange data a pipe's ring at a time, so a
+// pipeline needs constant memory however much flows through it
+static void cli_run_pipeline(char* stages[], int count) {
+    fs_node_t* pipes[CLI_MAX_STAGES - 1];
+    for (int i = 0; i < count - 1; i++) {
+        pipes[i] = pipe_create();
+        if (!pipes[i]) {
+            cli_print_error("Out of pipes");
+            while (i-- > 0) {
+                pipe_close(pipes[i], PIPE_READ_END | PIPE_WRITE_END);
+            }
+            return;
+        }
+    }
+    
+    for (int i = 0; i < count; i++) {
+        fs_node_t* in = i > 0 ? pipes[i - 1] : NULL;
+        fs_node_t* out = i < count - 1 ? pipes[i] : NULL;
+        
+        int id = task_create("cli stage", cli_stage_main, stages[i]);
+        if (id < 0) {
+            // The neighbours see end of input and a closed reader
+            cli_print_error("Out of tasks");
+            if (out) pipe_close(out, PIPE_WRITE_END);
+            if (in) pipe_close(in, PIPE_READ_END);
+            continue;
+        }
+        stage_io[id].in = in;
+        stage_io[id].out = out;
+        stages_running++;
+    }
+    
+    while (stages_running) {
+        futex_wait(&stages_running, stages_running);
+    }
+}
+
+static void cli_execute(char* input) {
+    
+    // Add to history
+    if (cli.history_count < CLI_HISTORY_SIZE) {
+        strcpy(cli.history[cli.history_count], input);
+        cli.history_count++;
+    }
+    
+    char* stages[CLI_MAX_STAGES];
+    int count = cli_split_pipeline(input, stages);
+    if (count < 0) {
+        cli_print_error("Too many pipeline stages");
+    } else if (count == 1) {
+        cli_run_command(stages[0]);
+    } else {
+        cli_run_pipeline(stages, count);
+    }
     
     cli_println("");
 }
 
+void cli_handle_input(char* input) {
+    if (!input || strlen(input) == 0) {
+        return;
+    }
+    
+    // Command name for the serial record (parsing splits the input in place)
+    char name[32];
+    int name_len = 0;
+    while (input[name_len] && input[name_len] != ' ' && name_len < (int)sizeof(name) - 1) {
+        name[name_len] = input[name_len];
+        name_len++;
+    }
+    name[name_len] = '\0';
+    
+    trace_event(TRACE_CLI_INPUT_BEGIN, 0, 0);
+    uint64_t start = cpu_rdtsc();
+    cli_execute(input);
+    uint64_t cycles = cpu_rdtsc() - start;
+    trace_event(TRACE_CLI_INPUT_END, 0, 0);
+    
+    // Completion record for scripted sessions (scripts/perf_suite.py)
+    serial_kv("cmd", "seq=%d name=%s cycles=%llu", cli.command_count++, name, cycles);
+}
+
+// Echo and run the line in the input buffer
+static void cli_submit(void) {
+    if (cli.buffer_pos > 0) {
+        cli.buffer[cli.buffer_pos] = '\0';
+        cli_print(cli.current_path);
+        cli_print("$ ");
+        cli_println(cli.buffer);
+        
+        cli_handle_input(cli.buffer);
+        
+        // Clear buffer
+        memset(cli.buffer, 0, sizeof(cli.buffer));
+        cli.buffer_pos = 0;
+    }
+}
+
+// ASCII input from the serial console (headless and scripted sessions)
+void cli_handle_char(char c) {
+    if (!cli.active) {
+        cli_toggle();
+    }
+    cli_dirty = 1;
+    
+    if (c == '\r' || c == '\n') {
+        cli_submit();
+    } else if (c == '\b' || c == 0x7F) {
+        if (cli.buffer_pos > 0) {
+            cli.buffer[--cli.buffer_pos] = '\0';
+        }
+    } else if (c >= ' ' && c <= '~' && cli.buffer_pos < CLI_BUFFER_SIZE - 1) {
+        cli.buffer[cli.buffer_pos++] = c;
+    }
+}
+
 void cli_handle_keypress(unsigned char key) {
     if (!cli.active) return;
+    cli_dirty = 1;
     
     switch (key) {
         case 0x1C: // Enter
-            if (cli.buffer_pos > 0) {
-                cli.buffer[cli.buffer_pos] = '\0';
-                cli_print(cli.current_path);
-                cli_print("$ ");
-                cli_println(cli.buffer);
-                
-                cli_handle_input(cli.buffer);
-                
-                // Clear buffer
-                memset(cli.buffer, 0, sizeof(cli.buffer));
-                cli.buffer_pos = 0;
-            }
+            cli_submit();
             break;
             
         case 0x0E: // Backspace
@@ -298,8 +514,11 @@ void cli_handle_keypress(unsigned char key) {
 }
 
 void cli_run() {
-    if (!cli.active) return;
+    if (!cli.active || !cli_dirty) return;
+    cli_dirty = 0;
+    frame_begin();
     cli_draw();
+    frame_present();
 }
 
 // Command implementations
@@ -308,19 +527,7 @@ int cmd_help(int argc, char* argv[]) {
     cli_println("==================");
     
     for (int i = 0; commands[i].handler != NULL; i++) {
-        char line[256];
-        strcpy(line, commands[i].name);
-        
-        // Pad with spaces
-        int len = strlen(line);
-        while (len < 12) {
-            strcat(line, " ");
-            len++;
-        }
-        
-        strcat(line, "- ");
-        strcat(line, commands[i].description);
-        cli_println(line);
+        cli_printf("%-12s- %s\n", commands[i].name, commands[i].description);
     }
     
     return 0;
@@ -333,94 +540,89 @@ int cmd_ls(int argc, char* argv[]) {
         return -1;
     }
     
-    if (argc > 1) {
-        dir = fs_find(argv[1]);
+    // ls [-a] [dir]; -a includes names starting with '.'
+    int all = argc > 1 && strcmp(argv[1], "-a") == 0;
+    int path = all ? 2 : 1;
+    if (argc > path) {
+        dir = fs_find(argv[path]);
         if (!dir) {
             cli_print_error("Directory not found");
             return -1;
         }
     }
     
-    if (!(dir->flags & FS_DIRECTORY)) {
+    if (FS_TYPE(dir) != FS_DIRECTORY) {
         cli_print_error("Not a directory");
         return -1;
     }
     
-    cli_print("Contents of ");
-    cli_print(dir->name);
-    cli_println(":");
+    cli_printf("Contents of %s:\n", fs_name(dir->name));
     
-    dirent_t* entry;
-    int index = 0;
-    while ((entry = fs_readdir(dir, index++))) {
-        char line[256];
+    fs_dir_t* cursor = fs_opendir(dir);
+    if (!cursor) {
+        cli_print_error("Cannot read directory");
+        return -1;
+    }
+    
+    fs_dir_entry_t* item;
+    while ((item = fs_readdir_next(cursor))) {
+        if (!all && fs_name(item->entry->name)[0] == '.') continue;
         
-        // Find the actual node to get type info
-        fs_node_t* node = fs_find(entry->name);
-        if (node) {
-            if (node->flags & FS_DIRECTORY) {
-                strcpy(line, "[DIR]  ");
-            } else {
-                strcpy(line, "[FILE] ");
-            }
-            strcat(line, entry->name);
-            
-            if (node->flags & FS_FILE) {
-                char size_str[32];
-                // Simple integer to string conversion
-                int size = node->length;
-                if (size == 0) {
-                    strcat(line, " (0 bytes)");
-                } else {
-                    strcat(line, " (");
-                    // Convert size to string manually
-                    char temp[16];
-                    int pos = 0;
-                    while (size > 0) {
-                        temp[pos++] = '0' + (size % 10);
-                        size /= 10;
-                    }
-                    for (int i = pos - 1; i >= 0; i--) {
-                        char c[2] = {temp[i], '\0'};
-                        strcat(line, c);
-                    }
-                    strcat(line, " bytes)");
-                }
-            }
+        if (!item->node) {
+            cli_printf("[???]  %s\n", fs_name(item->entry->name));
+        } else if (item->type == FS_DIRECTORY) {
+            cli_printf("[DIR]  %s\n", fs_name(item->entry->name));
         } else {
-            strcpy(line, "[???]  ");
-            strcat(line, entry->name);
+            cli_printf("[FILE] %s (%u bytes)\n", fs_name(item->entry->name), item->node->length);
         }
-        
-        cli_println(line);
     }
+    fs_closedir(cursor);
     
     return 0;
 }
 
-int cmd_cat(int argc, char* argv[]) {
-    if (argc < 2) {
-        cli_print_error("Usage: cat <filename>");
-        return -1;
+// Input of a command taking an optional file: argv[index] if given,
+// otherwise the pipe feeding this pipeline stage
+static fs_node_t* cli_open_input(int argc, char* argv[], int index, const char* usage) {
+    if (argc <= index) {
+        fs_node_t* in = stage_io[task_current()].in;
+        if (!in) cli_print_error((char*)usage);
+        return in;
     }
     
-    fs_node_t* file = fs_find(argv[1]);
+    fs_node_t* file = fs_find(argv[index]);
     if (!file) {
         cli_print_error("File not found");
-        return -1;
+        return NULL;
     }
-    
-    if (!(file->flags & FS_FILE)) {
+    if (FS_TYPE(file) != FS_FILE) {
         cli_print_error("Not a file");
-        return -1;
+        return NULL;
     }
+    return file;
+}
+
+// Streams any size in constant stack: ramdisk files are written straight
+// from storage, pipes and other nodes are copied a chunk at a time (see
+// fs_read_chunk())
+int cmd_cat(int argc, char* argv[]) {
+    fs_node_t* in = cli_open_input(argc, argv, 1, "Usage: cat <filename>");
+    if (!in) return -1;
     
-    char content[512];
-    uint32_t bytes_read = fs_read(file, 0, sizeof(content) - 1, (uint8_t*)content);
-    content[bytes_read] = '\0';
-    
-    cli_println(content);
+    char chunk[256];
+    uint32_t offset = 0;
+    char last = '\n';
+    for (;;) {
+        uint32_t size = sizeof(chunk);
+        const char* data = (const char*)fs_read_chunk(in, offset, (uint8_t*)chunk, &size);
+        if (size == 0) break;
+        
+        cli_write(data, size);
+        last = data[size - 1];
+        offset += size;
+    }
     
+    if (last != '\n') cli_write("\n", 1);
     return 0;
 }
 
@@ -437,7 +639,7 @@ int cmd_cd(int argc, char* argv[]) {
             return -1;
         }
         
-        if (!(target_dir->flags & FS_DIRECTORY)) {
+        if (FS_TYPE(target_dir) != FS_DIRECTORY) {
             cli_print_error("Not a directory");
             return -1;
         }
@@ -513,18 +715,64 @@ int cmd_clear(int argc, char* argv[]) {
     return 0;
 }
 
+#define CLI_TREE_MAX_DEPTH 15
+
+// Next entry tree shows; names starting with '.' are hidden as in ls
+static fs_dir_entry_t* cli_tree_next(fs_dir_t* cursor) {
+    fs_dir_entry_t* item = fs_readdir_next(cursor);
+    while (item && fs_name(item->entry->name)[0] == '.') {
+        item = fs_readdir_next(cursor);
+    }
+    return item;
+}
+
+// Print dir's children below prefix; each level adds four characters of
+// prefix, so the depth is bounded by the buffer
+static void cli_tree(fs_node_t* dir, char* prefix, int depth) {
+    fs_dir_t* cursor = fs_opendir(dir);
+    if (!cursor) return;
+    
+    size_t length = strlen(prefix);
+    fs_dir_entry_t* item = cli_tree_next(cursor);
+    while (item) {
+        // Look one ahead to know whether this is the last child
+        fs_dir_entry_t current = *item;
+        item = cli_tree_next(cursor);
+        int last = item == NULL;
+        
+        int is_dir = current.type == FS_DIRECTORY;
+        cli_printf("%s%s%s%s\n", prefix, last ? "`-- " : "|-- ",
+                   fs_name(current.entry->name), is_dir ? "/" : "");
+        if (!is_dir || !current.node) continue;
+        
+        if (depth == CLI_TREE_MAX_DEPTH) {
+            cli_printf("%s%s...\n", prefix, last ? "    " : "|   ");
+            continue;
+        }
+        strcpy(prefix + length, last ? "    " : "|   ");
+        cli_tree(current.node, prefix, depth + 1);
+        prefix[length] = '\0';
+    }
+    fs_closedir(cursor);
+}
+
 int cmd_tree(int argc, char* argv[]) {
-    cli_println("Directory tree structure:");
-    cli_println("========================");
-    // TODO: Implement tree traversal
-    cli_println("/ (root)");
-    cli_println("├── readme.txt");
-    cli_println("├── hello.txt");
-    cli_println("├── system.info");
-    cli_println("├── documents/");
-    cli_println("│   └── notes.txt");
-    cli_println("└── bin/");
-    cli_println("    └── test.exe");
+    fs_node_t* dir = get_root_directory();
+    if (argc > 1) {
+        dir = fs_find(argv[1]);
+        if (!dir) {
+            cli_print_error("Directory not found");
+            return -1;
+        }
+        if (FS_TYPE(dir) != FS_DIRECTORY) {
+            cli_print_error("Not a directory");
+            return -1;
+        }
+    }
+    
+    char prefix[CLI_TREE_MAX_DEPTH * 4 + 1] = "";
+    cli_printf("%s\n", argc > 1 ? argv[1] : "/");
+    cli_tree(dir, prefix, 0);
     
     return 0;
 }
@@ -541,34 +789,13 @@ int cmd_stat(int argc, char* argv[]) {
         return -1;
     }
     
-    cli_print("Name: ");
-    cli_println(node->name);
+    cli_printf("Name: %s\n", fs_name(node->name));
     
     cli_print("Type: ");
     cli_println(fs_get_file_type_string(node));
     
-    if (node->flags & FS_FILE) {
-        cli_print("Size: ");
-        // Convert size to string
-        char size_str[32];
-        int size = node->length;
-        int pos = 0;
-        if (size == 0) {
-            size_str[pos++] = '0';
-        } else {
-            char temp[16];
-            int temp_pos = 0;
-            while (size > 0) {
-                temp[temp_pos++] = '0' + (size % 10);
-                size /= 10;
-            }
-            for (int i = temp_pos - 1; i >= 0; i--) {
-                size_str[pos++] = temp[i];
-            }
-        }
-        size_str[pos] = '\0';
-        cli_print(size_str);
-        cli_println(" bytes");
+    if (FS_TYPE(node) == FS_FILE) {
+        cli_printf("Size: %u bytes\n", node->length);
     }
     
     return 0;
@@ -580,50 +807,282 @@ int cmd_mem(int argc, char* argv[]) {
     cli_println("Memory Information:");
     cli_println("==================");
     
-    // Convert numbers to strings and display
-    char buffer[64];
+    cli_printf("Total allocated: %u bytes\n", stats.total_allocated);
+    cli_printf("Allocations: %u\n", stats.allocation_count);
+    
+    if (paging_enabled()) {
+        paging_stats_t paging = paging_get_stats();
+        cli_printf("Committed pages: %u (%u KB)\n", paging.pages_committed,
+                   paging.pages_committed * (PAGE_SIZE / 1024));
+        cli_printf("Free frames: %u of %u\n", paging.frames_free, paging.frames_total);
+        cli_printf("Page faults: %u\n", paging.faults);
+    }
+    
+    return 0;
+}
+
+int cmd_bootlog(int argc, char* argv[]) {
+    cli_println("Boot log (TSC cycles):");
+    cli_println("==================");
+    
+    for (int i = 0; i < bootlog_count(); i++) {
+        const bootlog_stage_t* stage = bootlog_get(i);
+        cli_printf("%-14s%llu\n", stage->name, stage->end - stage->start);
+    }
+    cli_printf("%-14s%llu\n", "Total", bootlog_total());
+    
+#ifdef FAST_BOOT
+    cli_println("Fast boot: on");
+#else
+    cli_println("Fast boot: off");
+#endif
+    
+    return 0;
+}
+
+int cmd_trace(int argc, char* argv[]) {
+    if (argc < 2) {
+        cli_printf("Tracing %s, %u events buffered\n",
+                   trace_is_enabled() ? "on" : "off", trace_count());
+        cli_println("Usage: trace on|off|clear|dump|mark");
+        return 0;
+    }
     
-    // Total allocated
-    cli_print("Total allocated: ");
-    int size = stats.total_allocated;
-    int pos = 0;
-    if (size == 0) {
-        buffer[pos++] = '0';
+    if (strcmp(argv[1], "on") == 0) {
+        trace_enable(1);
+    } else if (strcmp(argv[1], "off") == 0) {
+        trace_enable(0);
+    } else if (strcmp(argv[1], "clear") == 0) {
+        trace_clear();
+    } else if (strcmp(argv[1], "dump") == 0) {
+        // Serial only: the dump is far larger than the CLI window
+        trace_dump(serial_write);
+        cli_printf("%u events written to serial\n", trace_count());
+    } else if (strcmp(argv[1], "mark") == 0) {
+        trace_event(TRACE_MARK, 0, 0);
     } else {
-        char temp[16];
-        int temp_pos = 0;
-        while (size > 0) {
-            temp[temp_pos++] = '0' + (size % 10);
-            size /= 10;
+        cli_print_error("Usage: trace on|off|clear|dump|mark");
+        return -1;
+    }
+    
+    return 0;
+}
+
+// Parse a decimal argument, 0 if it is not a number
+static uint32_t cli_parse_uint(const char* text) {
+    uint32_t value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+    }
+    return *text ? 0 : value;
+}
+
+int cmd_prof(int argc, char* argv[]) {
+    if (argc < 2) {
+        cli_printf("Profiler %s, %u samples (%u dropped)\n",
+                   prof_is_running() ? "running" : "stopped",
+                   prof_samples(), prof_dropped());
+        cli_println("Usage: prof start [hz]|stop|reset|top|dump");
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "start") == 0) {
+        uint32_t hz = argc > 2 ? cli_parse_uint(argv[2]) : PROF_DEFAULT_HZ;
+        prof_reset();
+        prof_start(hz);
+        cli_println("Profiling started");
+    } else if (strcmp(argv[1], "stop") == 0) {
+        prof_stop();
+        cli_printf("Profiling stopped, %u samples\n", prof_samples());
+    } else if (strcmp(argv[1], "reset") == 0) {
+        prof_reset();
+    } else if (strcmp(argv[1], "top") == 0) {
+        prof_entry_t top[8];
+        int count = prof_top(top, 8);
+        uint32_t total = prof_samples();
+        for (int i = 0; i < count; i++) {
+            cli_printf("0x%08x %6u %3u%%\n", top[i].eip, top[i].count,
+                       total ? top[i].count * 100 / total : 0);
+        }
+    } else if (strcmp(argv[1], "dump") == 0) {
+        // Symbolize on the host with scripts/symbolize_prof.py
+        prof_dump(serial_write);
+        cli_println("Histogram written to serial");
+    } else {
+        cli_print_error("Usage: prof start [hz]|stop|reset|top|dump");
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void cli_print_bench(const bench_t* bench) {
+    bench_result_t result;
+    bench_run(bench, &result);
+    cli_printf("%-12s%7u%7u%7u\n", bench->name, result.min, result.median, result.max);
+}
+
+int cmd_bench(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "list") == 0) {
+        for (int i = 0; i < bench_count(); i++) {
+            const bench_t* bench = bench_get(i);
+            cli_printf("%-12s %s\n", bench->name, bench->description);
         }
-        for (int i = temp_pos - 1; i >= 0; i--) {
-            buffer[pos++] = temp[i];
+        return 0;
+    }
+    
+    const bench_t* only = 0;
+    if (argc > 1) {
+        only = bench_find(argv[1]);
+        if (!only) {
+            cli_print_error("Unknown benchmark (try 'bench list')");
+            return -1;
         }
     }
-    buffer[pos] = '\0';
-    cli_print(buffer);
-    cli_println(" bytes");
     
-    // Allocation count
-    cli_print("Allocations: ");
-    size = stats.allocation_count;
-    pos = 0;
-    if (size == 0) {
-        buffer[pos++] = '0';
+    cli_printf("Cycles/op over %d runs\n", BENCH_RUNS);
+    cli_printf("%-12s%7s%7s%7s\n", "name", "min", "med", "max");
+    if (only) {
+        cli_print_bench(only);
     } else {
-        char temp[16];
-        int temp_pos = 0;
-        while (size > 0) {
-            temp[temp_pos++] = '0' + (size % 10);
-            size /= 10;
+        for (int i = 0; i < bench_count(); i++) {
+            cli_print_bench(bench_get(i));
         }
-        for (int i = temp_pos - 1; i >= 0; i--) {
-            buffer[pos++] = temp[i];
+    }
+    
+    return 0;
+}
+
+int cmd_fps(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        frame_reset_stats();
+        cli_println("Frame statistics reset");
+        return 0;
+    }
+    
+    frame_stats_t stats;
+    frame_get_stats(&stats);
+    cli_printf("Pacing: %s at %u Hz\n", frame_sync_name(stats.sync), stats.rate_hz);
+    cli_printf("Frames: %u\n", stats.frames);
+    cli_printf("Frame time (us): last %u avg %u worst %u\n",
+               stats.last_us, stats.avg_us, stats.worst_us);
+    serial_kv("fps", "sync=%s hz=%u frames=%u last_us=%u avg_us=%u worst_us=%u",
+              frame_sync_name(stats.sync), stats.rate_hz, stats.frames,
+              stats.last_us, stats.avg_us, stats.worst_us);
+    return 0;
+}
+
+int cmd_run(int argc, char* argv[]) {
+    if (argc < 2) {
+        cli_print_error("Usage: run <file>");
+        return -1;
+    }
+    
+    elf_stats_t before = elf_get_stats();
+    uint64_t start = cpu_rdtsc();
+    elf_program_t program;
+    int error = elf_load(argv[1], &program);
+    if (error != ELF_OK) {
+        cli_printf("Error: %s: %s\n", argv[1], elf_error_string(error));
+        return -1;
+    }
+    
+    // The program's standard output goes to this window
+    uint64_t loaded = cpu_rdtsc();
+    syscall_set_console(cli_write);
+    int status = elf_run(&program);
+    syscall_set_console(0);
+    uint64_t done = cpu_rdtsc();
+    elf_unload(&program);
+    
+    // Pages faulted in while loading and running: read from the file or
+    // mapped from the shared read-only cache
+    elf_stats_t after = elf_get_stats();
+    uint32_t read = after.pages_read - before.pages_read;
+    uint32_t shared = after.pages_shared - before.pages_shared;
+    cli_printf("Exit status %d\n", status);
+    cli_printf("Load %u cycles, run %u cycles\n",
+               (uint32_t)(loaded - start), (uint32_t)(done - loaded));
+    cli_printf("Pages: %u read, %u shared\n", read, shared);
+    serial_kv("run", "file=%s status=%d load_cycles=%u run_cycles=%u pages_read=%u pages_shared=%u",
+              argv[1], status, (uint32_t)(loaded - start), (uint32_t)(done - loaded), read, shared);
+    return status;
+}
+
+static int cli_grep_line(const char* line, uint32_t length, const char* pattern) {
+    if (!strstr(line, pattern)) return 0;
+    cli_write(line, length);
+    cli_write("\n", 1);
+    return 1;
+}
+
+// Streams its input through a bounded line buffer, so it works on input
+// of any length; longer lines are matched in CLI_LINE_MAX-1 byte pieces
+int cmd_grep(int argc, char* argv[]) {
+    if (argc < 2) {
+        cli_print_error("Usage: grep <text> [file]");
+        return -1;
+    }
+    
+    fs_node_t* in = cli_open_input(argc, argv, 2, "Usage: grep <text> [file]");
+    if (!in) return -1;
+    
+    char chunk[256];
+    char line[CLI_LINE_MAX];
+    uint32_t length = 0;
+    uint32_t offset = 0;
+    uint32_t matches = 0;
+    for (;;) {
+        uint32_t got = fs_read(in, offset, sizeof(chunk), (uint8_t*)chunk);
+        offset += got;
+        
+        for (uint32_t i = 0; i < got; i++) {
+            if (chunk[i] != '\n') {
+                line[length++] = chunk[i];
+                if (length < sizeof(line) - 1) continue;
+            }
+            line[length] = '\0';
+            matches += cli_grep_line(line, length, argv[1]);
+            length = 0;
+        }
+        
+        if (got == 0) {
+            // An unterminated last line
+            if (length > 0) {
+                line[length] = '\0';
+                matches += cli_grep_line(line, length, argv[1]);
+            }
+            break;
+        }
+    }
+    
+    serial_kv("grep", "pattern=%s bytes=%u matches=%u", argv[1], offset, matches);
+    return matches ? 0 : 1;
+}
+
+int cmd_wc(int argc, char* argv[]) {
+    fs_node_t* in = cli_open_input(argc, argv, 1, "Usage: wc [file]");
+    if (!in) return -1;
+    
+    char chunk[256];
+    uint32_t lines = 0, words = 0, bytes = 0;
+    int in_word = 0;
+    uint32_t got;
+    while ((got = fs_read(in, bytes, sizeof(chunk), (uint8_t*)chunk)) > 0) {
+        for (uint32_t i = 0; i < got; i++) {
+            char c = chunk[i];
+            if (c == '\n') lines++;
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                in_word = 0;
+            } else if (!in_word) {
+                in_word = 1;
+                words++;
+            }
         }
+        bytes += got;
     }
-    buffer[pos] = '\0';
-    cli_println(buffer);
     
+    cli_printf("%u %u %u\n", lines, words, bytes);
     return 0;
 }
 
@@ -18,6 +18,7 @@ typedef struct {
     int history_count;
     int history_index;
     char current_path[256];
+    int command_count;      // Commands run, numbers the serial records
 } cli_state_t;
 
 // Command structure
@@ -33,9 +34,12 @@ void cli_run();
 void cli_toggle();
 void cli_handle_input(char* input);
 void cli_handle_keypress(unsigned char key);
+void cli_handle_char(char c);
 void cli_draw();
 void cli_clear_screen();
+void cli_write(const char* text, size_t len);
 void cli_print(char* text);
+void cli_printf(const char* fmt, ...);
 void cli_println(char* text);
 void cli_prompt();
 
@@ -55,6 +59,14 @@ int cmd_clear(int argc, char* argv[]);
 int cmd_tree(int argc, char* argv[]);
 int cmd_stat(int argc, char* argv[]);
 int cmd_mem(int argc, char* argv[]);
+int cmd_bootlog(int argc, char* argv[]);
+int cmd_trace(int argc, char* argv[]);
+int cmd_prof(int argc, char* argv[]);
+int cmd_bench(int argc, char* argv[]);
+int cmd_fps(int argc, char* argv[]);
+int cmd_run(int argc, char* argv[]);
+int cmd_grep(int argc, char* argv[]);
+int cmd_wc(int argc, char* argv[]);
 int cmd_exit(int argc, char* argv[]);
 
 // Utility functions
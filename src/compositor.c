@@ -0,0 +1,294 @@
+#include "compositor.h"
+#include "string.h"
+#include "trace.h"
+#include "cursor.h"
+
+static surface_t* screen;
+static compositor_background_t paint_background;
+
+// Mapped windows, bottom to top
+static window_t* windows[COMPOSITOR_MAX_WINDOWS];
+static int window_count = 0;
+
+// Screen areas to recompose on the next flush
+static region_t screen_damage;
+static uint32_t last_flush_pixels = 0;
+
+int rect_intersect(const rect_t* a, const rect_t* b, rect_t* out) {
+    int x0 = a->x > b->x ? a->x : b->x;
+    int y0 = a->y > b->y ? a->y : b->y;
+    int x1 = a->x + a->width < b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height < b->y + b->height ? a->y + a->height : b->y + b->height;
+    if (x1 <= x0 || y1 <= y0) return 0;
+    out->x = x0;
+    out->y = y0;
+    out->width = x1 - x0;
+    out->height = y1 - y0;
+    return 1;
+}
+
+static void rect_union(rect_t* a, const rect_t* b) {
+    int x1 = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    if (b->x < a->x) a->x = b->x;
+    if (b->y < a->y) a->y = b->y;
+    a->width = x1 - a->x;
+    a->height = y1 - a->y;
+}
+
+static int region_append(region_t* region, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) return 1;
+    if (region->count >= REGION_MAX_RECTS) return 0;
+    rect_t* r = &region->rects[region->count++];
+    r->x = x;
+    r->y = y;
+    r->width = width;
+    r->height = height;
+    return 1;
+}
+
+// Replace the region by its bounding box joined with rect
+static void region_collapse(region_t* region, const rect_t* rect) {
+    rect_t bounds = *rect;
+    for (int i = 0; i < region->count; i++) {
+        rect_union(&bounds, &region->rects[i]);
+    }
+    region->rects[0] = bounds;
+    region->count = 1;
+}
+
+void region_clear(region_t* region) {
+    region->count = 0;
+}
+
+// Union; when the rect list would overflow the region degrades to its
+// bounding box, which is still a correct (if larger) damage area
+void region_add_rect(region_t* region, const rect_t* rect) {
+    if (rect->width <= 0 || rect->height <= 0) return;
+    if (!region_subtract_rect(region, rect) ||
+        !region_append(region, rect->x, rect->y, rect->width, rect->height)) {
+        region_collapse(region, rect);
+    }
+}
+
+// Cut rect out of every member, splitting each into at most four bands.
+// Returns 0 and leaves the region unchanged if the result would not fit
+int region_subtract_rect(region_t* region, const rect_t* rect) {
+    region_t result;
+    result.count = 0;
+    
+    for (int i = 0; i < region->count; i++) {
+        const rect_t* r = &region->rects[i];
+        rect_t hole;
+        if (!rect_intersect(r, rect, &hole)) {
+            if (!region_append(&result, r->x, r->y, r->width, r->height)) return 0;
+            continue;
+        }
+        int ok = region_append(&result, r->x, r->y, r->width, hole.y - r->y) &&
+                 region_append(&result, r->x, hole.y + hole.height, r->width,
+                               r->y + r->height - hole.y - hole.height) &&
+                 region_append(&result, r->x, hole.y, hole.x - r->x, hole.height) &&
+                 region_append(&result, hole.x + hole.width, hole.y,
+                               r->x + r->width - hole.x - hole.width, hole.height);
+        if (!ok) return 0;
+    }
+    
+    *region = result;
+    return 1;
+}
+
+void region_intersect_rect(region_t* out, const region_t* region, const rect_t* clip) {
+    out->count = 0;
+    for (int i = 0; i < region->count; i++) {
+        if (rect_intersect(&region->rects[i], clip, &out->rects[out->count])) {
+            out->count++;
+        }
+    }
+}
+
+void compositor_init(surface_t* target, compositor_background_t background) {
+    screen = target;
+    paint_background = background;
+    window_count = 0;
+    region_clear(&screen_damage);
+}
+
+void window_init(window_t* window, uint8_t* pixels, int x, int y, int width, int height) {
+    window->frame.x = x;
+    window->frame.y = y;
+    window->frame.width = width;
+    window->frame.height = height;
+    surface_init(&window->surface, pixels, width, height, width, SURFACE_8BPP);
+    region_clear(&window->damage);
+    window->mapped = 0;
+}
+
+static int window_index(window_t* window) {
+    for (int i = 0; i < window_count; i++) {
+        if (windows[i] == window) return i;
+    }
+    return -1;
+}
+
+int compositor_map(window_t* window) {
+    if (window->mapped) return 0;
+    if (window_count >= COMPOSITOR_MAX_WINDOWS) return -1;
+    windows[window_count++] = window;
+    window->mapped = 1;
+    region_add_rect(&screen_damage, &window->frame);
+    return 0;
+}
+
+void compositor_unmap(window_t* window) {
+    int index = window_index(window);
+    if (index < 0) return;
+    for (int i = index; i < window_count - 1; i++) {
+        windows[i] = windows[i + 1];
+    }
+    window_count--;
+    window->mapped = 0;
+    region_clear(&window->damage);
+    region_add_rect(&screen_damage, &window->frame);
+}
+
+void compositor_raise(window_t* window) {
+    int index = window_index(window);
+    if (index < 0 || index == window_count - 1) return;
+    
+    // Only the parts that windows above were hiding become visible
+    for (int i = index + 1; i < window_count; i++) {
+        rect_t hidden;
+        if (rect_intersect(&window->frame, &windows[i]->frame, &hidden)) {
+            region_add_rect(&screen_damage, &hidden);
+        }
+        windows[i - 1] = windows[i];
+    }
+    windows[window_count - 1] = window;
+}
+
+// The window's pixels come from its backing store at the new position;
+// the uncovered part of the old frame is repainted from whatever is below
+void compositor_move(window_t* window, int x, int y) {
+    if (x == window->frame.x && y == window->frame.y) return;
+    rect_t old_frame = window->frame;
+    window->frame.x = x;
+    window->frame.y = y;
+    if (!window->mapped) return;
+    
+    region_t exposed;
+    exposed.count = 1;
+    exposed.rects[0] = old_frame;
+    if (region_subtract_rect(&exposed, &window->frame)) {
+        for (int i = 0; i < exposed.count; i++) {
+            region_add_rect(&screen_damage, &exposed.rects[i]);
+        }
+    } else {
+        region_add_rect(&screen_damage, &old_frame);
+    }
+    region_add_rect(&screen_damage, &window->frame);
+}
+
+void compositor_damage(window_t* window, int x, int y, int width, int height) {
+    rect_t area = { x, y, width, height };
+    rect_t bounds = { 0, 0, window->frame.width, window->frame.height };
+    rect_t clipped;
+    if (window->mapped && rect_intersect(&area, &bounds, &clipped)) {
+        region_add_rect(&window->damage, &clipped);
+    }
+}
+
+void compositor_damage_screen(int x, int y, int width, int height) {
+    rect_t area = { x, y, width, height };
+    region_add_rect(&screen_damage, &area);
+}
+
+static void blit_window(window_t* window, const rect_t* area) {
+    surface_blit(screen, area->x, area->y, &window->surface,
+                 area->x - window->frame.x, area->y - window->frame.y,
+                 area->width, area->height);
+    last_flush_pixels += area->width * area->height;
+}
+
+static void draw_background(const rect_t* area) {
+    if (paint_background) {
+        paint_background(area->x, area->y, area->width, area->height);
+    }
+    last_flush_pixels += area->width * area->height;
+}
+
+// Painter's order for one damage rect; only used when the occlusion split
+// would overflow a region
+static void compose_overdraw(const rect_t* area) {
+    draw_background(area);
+    for (int i = 0; i < window_count; i++) {
+        rect_t part;
+        if (rect_intersect(area, &windows[i]->frame, &part)) {
+            blit_window(windows[i], &part);
+        }
+    }
+}
+
+// Front to back: each window draws the part of the damage nobody above
+// it covers, then its frame is cut out of what is left
+static void compose(const rect_t* area) {
+    region_t todo;
+    todo.count = 1;
+    todo.rects[0] = *area;
+    
+    for (int i = window_count - 1; i >= 0 && todo.count > 0; i--) {
+        window_t* window = windows[i];
+        region_t visible;
+        region_intersect_rect(&visible, &todo, &window->frame);
+        if (visible.count == 0) continue;
+        
+        region_t remaining = todo;
+        if (!region_subtract_rect(&remaining, &window->frame)) {
+            compose_overdraw(area);
+            return;
+        }
+        for (int j = 0; j < visible.count; j++) {
+            blit_window(window, &visible.rects[j]);
+        }
+        todo = remaining;
+    }
+    
+    for (int i = 0; i < todo.count; i++) {
+        draw_background(&todo.rects[i]);
+    }
+}
+
+void compositor_flush(void) {
+    if (!screen) return;
+    
+    // Move per-window damage to screen coordinates
+    for (int i = 0; i < window_count; i++) {
+        window_t* window = windows[i];
+        for (int j = 0; j < window->damage.count; j++) {
+            rect_t area = window->damage.rects[j];
+            area.x += window->frame.x;
+            area.y += window->frame.y;
+            region_add_rect(&screen_damage, &area);
+        }
+        region_clear(&window->damage);
+    }
+    if (screen_damage.count == 0) return;
+    
+    trace_event(TRACE_COMPOSE_BEGIN, screen_damage.count, 0);
+    int cursor = cursor_hide();
+    last_flush_pixels = 0;
+    rect_t bounds = { 0, 0, screen->width, screen->height };
+    for (int i = 0; i < screen_damage.count; i++) {
+        rect_t area;
+        if (rect_intersect(&screen_damage.rects[i], &bounds, &area)) {
+            compose(&area);
+        }
+    }
+    region_clear(&screen_damage);
+    if (cursor) cursor_show();
+    trace_event(TRACE_COMPOSE_END, last_flush_pixels, 0);
+}
+
+// Pixels written by the most recent flush that had damage
+uint32_t compositor_last_flush_pixels(void) {
+    return last_flush_pixels;
+}
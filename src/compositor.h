@@ -0,0 +1,56 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <stdint.h>
+#include "surface.h"
+
+// Compositor limits
+#define COMPOSITOR_MAX_WINDOWS  8
+#define REGION_MAX_RECTS        32
+
+typedef struct {
+    int x, y;
+    int width, height;
+} rect_t;
+
+// A set of disjoint rectangles
+typedef struct {
+    int count;
+    rect_t rects[REGION_MAX_RECTS];
+} region_t;
+
+// An opaque window; its contents live in a backing store surface of the
+// frame's size, so the compositor can redraw any part of it with a blit
+typedef struct {
+    rect_t frame;           // Screen position and size
+    surface_t surface;      // Backing store, drawn by the window's owner
+    region_t damage;        // Changed areas, window coordinates
+    int mapped;
+} window_t;
+
+// Paints the area below every window (e.g. gui_restore_desktop)
+typedef void (*compositor_background_t)(int x, int y, int width, int height);
+
+// Rect and region functions
+int rect_intersect(const rect_t* a, const rect_t* b, rect_t* out);
+void region_clear(region_t* region);
+void region_add_rect(region_t* region, const rect_t* rect);
+int region_subtract_rect(region_t* region, const rect_t* rect);
+void region_intersect_rect(region_t* out, const region_t* region, const rect_t* clip);
+
+// Compositor functions
+// Windows are kept in z-order, last mapped or raised on top. Nothing
+// reaches the screen until compositor_flush(), which draws each damaged
+// pixel exactly once from the topmost window covering it
+void compositor_init(surface_t* screen, compositor_background_t background);
+void window_init(window_t* window, uint8_t* pixels, int x, int y, int width, int height);
+int compositor_map(window_t* window);
+void compositor_unmap(window_t* window);
+void compositor_raise(window_t* window);
+void compositor_move(window_t* window, int x, int y);
+void compositor_damage(window_t* window, int x, int y, int width, int height);
+void compositor_damage_screen(int x, int y, int width, int height);
+void compositor_flush(void);
+uint32_t compositor_last_flush_pixels(void);
+
+#endif // COMPOSITOR_H
@@ -0,0 +1,145 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdint.h>
+
+// Control register bits
+#define CR0_MP          (1u << 1)   // Monitor coprocessor
+#define CR0_EM          (1u << 2)   // x87 emulation
+#define CR0_TS          (1u << 3)   // Task switched
+#define CR0_WP          (1u << 16)  // Honour read-only pages in ring 0
+#define CR0_PG          (1u << 31)  // Paging
+#define CR4_OSFXSR      (1u << 9)   // FXSAVE/FXRSTOR and SSE enabled
+#define CR4_OSXMMEXCPT  (1u << 10)  // Unmasked SSE exceptions supported
+
+// CPUID leaf 1 EDX feature bits
+#define CPUID_EDX_FPU   (1u << 0)
+#define CPUID_EDX_TSC   (1u << 4)
+#define CPUID_EDX_SEP   (1u << 11)  // SYSENTER/SYSEXIT
+#define CPUID_EDX_FXSR  (1u << 24)
+#define CPUID_EDX_SSE   (1u << 25)
+#define CPUID_EDX_SSE2  (1u << 26)
+
+// Read the CPU time stamp counter
+static inline uint64_t cpu_rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// CPUID is available if the ID flag (EFLAGS bit 21) can be toggled
+static inline int cpu_has_cpuid(void) {
+    uint32_t before, after;
+    asm volatile("pushfl\n\t"
+                 "pushfl\n\t"
+                 "popl %0\n\t"
+                 "movl %0, %1\n\t"
+                 "xorl $0x200000, %1\n\t"
+                 "pushl %1\n\t"
+                 "popfl\n\t"
+                 "pushfl\n\t"
+                 "popl %1\n\t"
+                 "popfl"
+                 : "=&r"(before), "=&r"(after));
+    return ((before ^ after) & 0x200000) != 0;
+}
+
+static inline void cpu_cpuid(uint32_t leaf, uint32_t* eax, uint32_t* ebx, uint32_t* ecx, uint32_t* edx) {
+    asm volatile("cpuid"
+                 : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                 : "a"(leaf), "c"(0));
+}
+
+// Model-specific registers
+#define MSR_SYSENTER_CS     0x174
+#define MSR_SYSENTER_ESP    0x175
+#define MSR_SYSENTER_EIP    0x176
+
+static inline void cpu_wrmsr(uint32_t msr, uint64_t value) {
+    asm volatile("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+static inline uint32_t cpu_read_cr0(void) {
+    uint32_t value;
+    asm volatile("movl %%cr0, %0" : "=r"(value));
+    return value;
+}
+
+static inline void cpu_write_cr0(uint32_t value) {
+    asm volatile("movl %0, %%cr0" : : "r"(value) : "memory");
+}
+
+static inline uint32_t cpu_read_cr2(void) {
+    uint32_t value;
+    asm volatile("movl %%cr2, %0" : "=r"(value));
+    return value;
+}
+
+static inline uint32_t cpu_read_cr3(void) {
+    uint32_t value;
+    asm volatile("movl %%cr3, %0" : "=r"(value));
+    return value;
+}
+
+static inline void cpu_write_cr3(uint32_t value) {
+    asm volatile("movl %0, %%cr3" : : "r"(value) : "memory");
+}
+
+static inline void cpu_invlpg(uint32_t address) {
+    asm volatile("invlpg (%0)" : : "r"(address) : "memory");
+}
+
+static inline uint32_t cpu_read_cr4(void) {
+    uint32_t value;
+    asm volatile("movl %%cr4, %0" : "=r"(value));
+    return value;
+}
+
+static inline void cpu_write_cr4(uint32_t value) {
+    asm volatile("movl %0, %%cr4" : : "r"(value) : "memory");
+}
+
+// Port I/O
+static inline uint8_t cpu_inb(uint16_t port) {
+    uint8_t value;
+    asm volatile("inb %1, %0" : "=a"(value) : "Nd"(port));
+    return value;
+}
+
+static inline void cpu_outb(uint16_t port, uint8_t value) {
+    asm volatile("outb %0, %1" : : "a"(value), "Nd"(port));
+}
+
+// Short delay for slow devices (port 0x80 is the POST diagnostic port)
+static inline void cpu_io_wait(void) {
+    cpu_outb(0x80, 0);
+}
+
+// Interrupt flag
+#define EFLAGS_IF       (1u << 9)
+
+static inline void cpu_enable_interrupts(void) {
+    asm volatile("sti" : : : "memory");
+}
+
+static inline void cpu_disable_interrupts(void) {
+    asm volatile("cli" : : : "memory");
+}
+
+// Disable interrupts and return the previous EFLAGS for cpu_irq_restore()
+static inline uint32_t cpu_irq_save(void) {
+    uint32_t flags;
+    asm volatile("pushfl\n\t"
+                 "popl %0\n\t"
+                 "cli"
+                 : "=r"(flags) : : "memory");
+    return flags;
+}
+
+static inline void cpu_irq_restore(uint32_t flags) {
+    if (flags & EFLAGS_IF) {
+        cpu_enable_interrupts();
+    }
+}
+
+#endif // CPU_H
@@ -0,0 +1,87 @@
+#include "cursor.h"
+#include "gui.h"
+
+// Arrow shape: 'X' outline, 'o' fill, '.' transparent
+static const char* cursor_shape[CURSOR_HEIGHT] = {
+    "X.........",
+    "XX........",
+    "XoX.......",
+    "XooX......",
+    "XoooX.....",
+    "XooooX....",
+    "XoooooX...",
+    "XooooooX..",
+    "XoooooooX.",
+    "XooooooooX",
+    "XooooXXXXX",
+    "XoXooX....",
+    "XX.XooX...",
+    "X..XooX...",
+    "....XooX..",
+    ".....XX...",
+};
+
+static surface_t* screen = 0;
+static uint32_t save_pixels[CURSOR_WIDTH * CURSOR_HEIGHT]; // Room for 32bpp
+static surface_t save_under;
+static int cursor_x = 0;
+static int cursor_y = 0;
+static int visible = 0;
+
+// The hotspot is the top-left pixel and is kept on screen, so only the
+// right and bottom edges ever clip; saving and restoring clip alike
+static void cursor_draw(void) {
+    surface_blit(&save_under, 0, 0, screen, cursor_x, cursor_y, CURSOR_WIDTH, CURSOR_HEIGHT);
+    for (int y = 0; y < CURSOR_HEIGHT; y++) {
+        const char* row = cursor_shape[y];
+        for (int x = 0; x < CURSOR_WIDTH; x++) {
+            if (row[x] == 'X') {
+                surface_put_pixel(screen, cursor_x + x, cursor_y + y, COLOR_BLACK);
+            } else if (row[x] == 'o') {
+                surface_put_pixel(screen, cursor_x + x, cursor_y + y, COLOR_LWHITE);
+            }
+        }
+    }
+    visible = 1;
+}
+
+void cursor_init(surface_t* target, int x, int y) {
+    screen = target;
+    surface_init(&save_under, (uint8_t*)save_pixels, CURSOR_WIDTH, CURSOR_HEIGHT,
+                 CURSOR_WIDTH * target->bpp / 8, target->bpp);
+    visible = 0;
+    cursor_x = 0;
+    cursor_y = 0;
+    cursor_move(x, y);
+}
+
+void cursor_move(int x, int y) {
+    if (!screen) return;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x >= screen->width) x = screen->width - 1;
+    if (y >= screen->height) y = screen->height - 1;
+    if (visible && x == cursor_x && y == cursor_y) return;
+    
+    cursor_hide();
+    cursor_x = x;
+    cursor_y = y;
+    cursor_draw();
+}
+
+// Put the saved pixels back; returns whether the cursor was showing
+int cursor_hide(void) {
+    if (!visible) return 0;
+    surface_blit(screen, cursor_x, cursor_y, &save_under, 0, 0, CURSOR_WIDTH, CURSOR_HEIGHT);
+    visible = 0;
+    return 1;
+}
+
+void cursor_show(void) {
+    if (screen && !visible) cursor_draw();
+}
+
+void cursor_get_position(int* x, int* y) {
+    *x = cursor_x;
+    *y = cursor_y;
+}
@@ -0,0 +1,22 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "surface.h"
+
+// Software pointer, drawn straight onto the screen surface
+#define CURSOR_WIDTH    10
+#define CURSOR_HEIGHT   16
+
+// Cursor functions
+// The pixels under the pointer are kept in a save-under buffer: a move
+// restores them, saves the new spot and draws the pointer there, so only
+// about 2 * CURSOR_WIDTH * CURSOR_HEIGHT pixels are touched. Anything that
+// draws to the screen under the pointer must hide it first (the
+// compositor does this in compositor_flush)
+void cursor_init(surface_t* screen, int x, int y);
+void cursor_move(int x, int y);
+int cursor_hide(void);
+void cursor_show(void);
+void cursor_get_position(int* x, int* y);
+
+#endif // CURSOR_H
@@ -0,0 +1,239 @@
+#include "elf.h"
+#include "memory.h"
+#include "string.h"
+#include "syscall.h"
+
+static elf_image_t images[ELF_MAX_IMAGES];
+static elf_stats_t stats;
+
+static uint32_t elf_segment_pages(const elf_segment_t* seg) {
+    uint32_t end = (seg->vaddr + seg->memsz + PAGE_SIZE - 1) & PAGE_MASK;
+    return (end - (seg->vaddr & PAGE_MASK)) / PAGE_SIZE;
+}
+
+// Drop an unused image and the read-only frames it cached
+static void elf_drop_image(elf_image_t* image) {
+    for (int i = 0; i < image->segment_count; i++) {
+        elf_segment_t* seg = &image->segments[i];
+        if (!seg->shared) continue;
+    
+        uint32_t pages = elf_segment_pages(seg);
+        for (uint32_t p = 0; p < pages; p++) {
+            if (seg->shared[p]) paging_free_frame(seg->shared[p]);
+        }
+        free(seg->shared);
+    }
+    memset(image, 0, sizeof(*image));
+}
+
+// Check a PT_LOAD header against the file and the user address range
+static int elf_check_segment(fs_node_t* node, const elf32_phdr_t* ph, const elf_segment_t* prev) {
+    uint32_t end = ph->vaddr + ph->memsz;
+    if (ph->filesz > ph->memsz || ph->memsz == 0 || end < ph->vaddr) return 0;
+    if (ph->offset + ph->filesz < ph->offset || ph->offset + ph->filesz > node->length) return 0;
+    if ((ph->vaddr - ph->offset) & (PAGE_SIZE - 1)) return 0;
+    if (ph->vaddr < ELF_USER_BASE || end > ELF_USER_END) return 0;
+    
+    // Segments come in address order and each gets its own pages, since
+    // one page cannot be both shared read-only and private
+    if (prev && (ph->vaddr & PAGE_MASK) < ((prev->vaddr + prev->memsz + PAGE_SIZE - 1) & PAGE_MASK)) {
+        return 0;
+    }
+    return 1;
+}
+
+static int elf_parse(fs_node_t* node, elf_image_t* image) {
+    elf32_ehdr_t eh;
+    if (fs_read(node, 0, sizeof(eh), (uint8_t*)&eh) != sizeof(eh)) return ELF_ERR_FORMAT;
+    if (eh.magic != ELF_MAGIC || eh.class != ELF_CLASS32 || eh.data != ELF_DATA_LSB ||
+        eh.type != ELF_TYPE_EXEC || eh.machine != ELF_MACHINE_386 || eh.version != ELF_VERSION ||
+        eh.phentsize != sizeof(elf32_phdr_t) || eh.phnum == 0 || eh.phnum > ELF_MAX_PHDRS) {
+        return ELF_ERR_FORMAT;
+    }
+    
+    image->node = node;
+    image->modified_time = node->modified_time;
+    image->entry = eh.entry;
+    image->segment_count = 0;
+    
+    int entry_ok = 0;
+    for (int i = 0; i < eh.phnum; i++) {
+        elf32_phdr_t ph;
+        if (fs_read(node, eh.phoff + i * sizeof(ph), sizeof(ph), (uint8_t*)&ph) != sizeof(ph)) {
+            return ELF_ERR_FORMAT;
+        }
+        if (ph.type != ELF_PT_LOAD) continue;
+    
+        elf_segment_t* prev = image->segment_count ? &image->segments[image->segment_count - 1] : 0;
+        if (image->segment_count == ELF_MAX_SEGMENTS || !elf_check_segment(node, &ph, prev)) {
+            return ELF_ERR_SEGMENT;
+        }
+    
+        elf_segment_t* seg = &image->segments[image->segment_count++];
+        seg->image = image;
+        seg->vaddr = ph.vaddr;
+        seg->memsz = ph.memsz;
+        seg->filesz = ph.filesz;
+        seg->offset = ph.offset;
+        seg->flags = ph.flags;
+        seg->shared = 0;
+        if (!(ph.flags & ELF_PF_W)) {
+            uint32_t pages = elf_segment_pages(seg);
+            seg->shared = (uint32_t*)malloc(pages * sizeof(uint32_t));
+            if (!seg->shared) return ELF_ERR_NO_MEMORY;
+            memset(seg->shared, 0, pages * sizeof(uint32_t));
+        }
+    
+        if ((ph.flags & ELF_PF_X) && eh.entry >= ph.vaddr && eh.entry < ph.vaddr + ph.memsz) {
+            entry_ok = 1;
+        }
+    }
+    
+    return entry_ok ? ELF_OK : ELF_ERR_FORMAT;
+}
+
+// Cached image for node, parsing it on first use or after it changed
+static int elf_get_image(fs_node_t* node, elf_image_t** result) {
+    elf_image_t* slot = 0;
+    for (int i = 0; i < ELF_MAX_IMAGES; i++) {
+        elf_image_t* image = &images[i];
+        if (image->node == node) {
+            if (image->modified_time == node->modified_time) {
+                *result = image;
+                return ELF_OK;
+            }
+            if (image->users) return ELF_ERR_IN_USE;
+            elf_drop_image(image);
+        }
+        if (!image->node && !slot) slot = image;
+    }
+    
+    // Evict an unused image when the cache is full
+    for (int i = 0; i < ELF_MAX_IMAGES && !slot; i++) {
+        if (!images[i].users) {
+            elf_drop_image(&images[i]);
+            slot = &images[i];
+        }
+    }
+    if (!slot) return ELF_ERR_IN_USE;
+    
+    int error = elf_parse(node, slot);
+    if (error != ELF_OK) {
+        elf_drop_image(slot);
+        return error;
+    }
+    *result = slot;
+    return ELF_OK;
+}
+
+// Fill the frame for the page at address: file bytes where the segment
+// has them, zeros for the rest (.bss and page padding)
+static void elf_fill_page(elf_segment_t* seg, uint32_t address, uint8_t* page) {
+    uint32_t start = address > seg->vaddr ? address : seg->vaddr;
+    uint32_t end = address + PAGE_SIZE;
+    if (end > seg->vaddr + seg->filesz) end = seg->vaddr + seg->filesz;
+    
+    if (start >= end) {
+        memset(page, 0, PAGE_SIZE);
+        return;
+    }
+    memset(page, 0, start - address);
+    uint32_t got = fs_read(seg->image->node, seg->offset + (start - seg->vaddr), end - start,
+                           page + (start - address));
+    memset(page + (start - address) + got, 0, PAGE_SIZE - (start - address) - got);
+    stats.pages_read++;
+    stats.bytes_read += got;
+}
+
+// Demand fault for a program segment
+static int elf_fault(vm_region_t* region, uint32_t address) {
+    elf_segment_t* seg = (elf_segment_t*)region->data;
+    
+    if (seg->shared) {
+        uint32_t* slot = &seg->shared[(address - region->start) / PAGE_SIZE];
+        if (*slot) {
+            stats.pages_shared++;
+        } else {
+            uint32_t frame = paging_alloc_frame();
+            if (!frame) return -1;
+            elf_fill_page(seg, address, (uint8_t*)frame);
+            *slot = frame;
+        }
+        return paging_map(address, *slot, region->flags);
+    }
+    
+    uint32_t frame = paging_alloc_frame();
+    if (!frame) return -1;
+    elf_fill_page(seg, address, (uint8_t*)frame);
+    if (paging_map(address, frame, region->flags) != 0) {
+        paging_free_frame(frame);
+        return -1;
+    }
+    return 0;
+}
+
+// Reserve the program's segments; pages are read from the file as the
+// program first touches them
+int elf_load(const char* path, elf_program_t* program) {
+    memset(program, 0, sizeof(*program));
+    
+    fs_node_t* node = fs_find((char*)path);
+    if (!node || FS_TYPE(node) != FS_FILE) return ELF_ERR_NOT_FOUND;
+    
+    elf_image_t* image;
+    int error = elf_get_image(node, &image);
+    if (error != ELF_OK) return error;
+    
+    program->image = image;
+    program->entry = image->entry;
+    image->users++;
+    
+    for (int i = 0; i < image->segment_count; i++) {
+        elf_segment_t* seg = &image->segments[i];
+        uint32_t flags = PAGE_USER | ((seg->flags & ELF_PF_W) ? PAGE_WRITE : VM_SHARED);
+        uint32_t start = seg->vaddr & PAGE_MASK;
+        program->regions[i] = paging_reserve(start, seg->vaddr + seg->memsz - start, flags,
+                                             fs_name(node->name), elf_fault, seg);
+        if (!program->regions[i]) {
+            elf_unload(program);
+            return ELF_ERR_IN_USE;
+        }
+    }
+    
+    stats.loads++;
+    return ELF_OK;
+}
+
+// Unmap the program; private pages are freed, shared ones stay cached
+void elf_unload(elf_program_t* program) {
+    if (!program->image) return;
+    
+    for (int i = 0; i < ELF_MAX_SEGMENTS; i++) {
+        if (program->regions[i]) {
+            paging_release(program->regions[i]);
+            program->regions[i] = 0;
+        }
+    }
+    program->image->users--;
+    program->image = 0;
+}
+
+int elf_run(elf_program_t* program) {
+    return syscall_run_user(program->entry, 0);
+}
+
+const char* elf_error_string(int error) {
+    switch (error) {
+        case ELF_OK:            return "ok";
+        case ELF_ERR_NOT_FOUND: return "file not found";
+        case ELF_ERR_FORMAT:    return "not an i386 ELF executable";
+        case ELF_ERR_SEGMENT:   return "unsupported segment layout";
+        case ELF_ERR_IN_USE:    return "address range in use";
+        case ELF_ERR_NO_MEMORY: return "out of memory";
+        default:                return "unknown error";
+    }
+}
+
+elf_stats_t elf_get_stats(void) {
+    return stats;
+}
@@ -0,0 +1,118 @@
+#ifndef ELF_H
+#define ELF_H
+
+#include <stdint.h>
+#include "fs.h"
+#include "paging.h"
+
+// ELF32 file format (System V ABI, i386 supplement)
+#define ELF_MAGIC           0x464C457F  // "\x7FELF" read little endian
+#define ELF_CLASS32         1
+#define ELF_DATA_LSB        1
+#define ELF_VERSION         1
+#define ELF_TYPE_EXEC       2
+#define ELF_MACHINE_386     3
+
+#define ELF_PT_LOAD         1
+#define ELF_PF_X            0x1
+#define ELF_PF_W            0x2
+#define ELF_PF_R            0x4
+
+typedef struct {
+    uint32_t magic;
+    uint8_t class;
+    uint8_t data;
+    uint8_t ident_version;
+    uint8_t pad[9];
+    uint16_t type;
+    uint16_t machine;
+    uint32_t version;
+    uint32_t entry;
+    uint32_t phoff;
+    uint32_t shoff;
+    uint32_t flags;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t phnum;
+    uint16_t shentsize;
+    uint16_t shnum;
+    uint16_t shstrndx;
+} __attribute__((packed)) elf32_ehdr_t;
+
+typedef struct {
+    uint32_t type;
+    uint32_t offset;
+    uint32_t vaddr;
+    uint32_t paddr;
+    uint32_t filesz;
+    uint32_t memsz;
+    uint32_t flags;
+    uint32_t align;
+} __attribute__((packed)) elf32_phdr_t;
+
+// Programs live between the identity map and the user stack's guard
+#define ELF_USER_BASE       PAGING_USER_BASE
+#define ELF_USER_END        (PAGING_USER_STACK_TOP - PAGING_USER_STACK_SIZE - PAGE_SIZE)
+
+#define ELF_MAX_PHDRS       16
+#define ELF_MAX_SEGMENTS    4
+#define ELF_MAX_IMAGES      4
+
+// elf_load() results
+#define ELF_OK              0
+#define ELF_ERR_NOT_FOUND   -1
+#define ELF_ERR_FORMAT      -2      // Not an i386 ELF executable
+#define ELF_ERR_SEGMENT     -3      // Unsupported segment layout
+#define ELF_ERR_IN_USE      -4      // Address range or image busy
+#define ELF_ERR_NO_MEMORY   -5
+
+typedef struct elf_image elf_image_t;
+
+// A PT_LOAD segment; read-only segments keep the frames they have
+// faulted in so every instance of the program shares them
+typedef struct {
+    elf_image_t* image;
+    uint32_t vaddr;
+    uint32_t memsz;
+    uint32_t filesz;
+    uint32_t offset;
+    uint32_t flags;             // ELF_PF_*
+    uint32_t* shared;           // Frame per page, 0 until first touched
+} elf_segment_t;
+
+// Parsed executable, cached per file until the file changes
+struct elf_image {
+    fs_node_t* node;
+    uint32_t modified_time;     // Version of the file the cache holds
+    uint32_t entry;
+    int segment_count;
+    elf_segment_t segments[ELF_MAX_SEGMENTS];
+    int users;                  // Loaded programs using the image
+};
+
+// A loaded instance: one reserved region per segment, nothing mapped
+// until the program touches it
+typedef struct {
+    elf_image_t* image;
+    uint32_t entry;
+    vm_region_t* regions[ELF_MAX_SEGMENTS];
+} elf_program_t;
+
+typedef struct {
+    uint32_t loads;
+    uint32_t pages_read;        // Pages filled from the file
+    uint32_t pages_shared;      // Faults served from the shared cache
+    uint32_t bytes_read;
+} elf_stats_t;
+
+// ELF loader functions
+// Programs share one address space, so only one instance can be loaded
+// at a time; read-only pages stay cached for the next one. elf_run()
+// enters the program in ring 3 and returns its exit status
+int elf_load(const char* path, elf_program_t* program);
+void elf_unload(elf_program_t* program);
+int elf_run(elf_program_t* program);
+const char* elf_error_string(int error);
+elf_stats_t elf_get_stats(void);
+
+#endif // ELF_H
@@ -0,0 +1,85 @@
+#include "fpu.h"
+#include "cpu.h"
+#include "string.h"
+
+// SSE2 bulk kernels (sse.asm)
+extern void* sse2_memcpy(void* dest, const void* src, size_t num);
+extern void* sse2_memset(void* ptr, int value, size_t num);
+
+static uint32_t features = 0;
+
+// Probe the CPU, enable the x87 unit and, where supported, SSE with
+// FXSAVE/FXRSTOR. Compiled C never uses SSE registers (-mno-sse), so the
+// SSE2 kernels are only reached through the string.c bulk hooks.
+void fpu_init(void) {
+    uint32_t eax, ebx, ecx, edx = 0;
+    
+    features = 0;
+    if (cpu_has_cpuid()) {
+        cpu_cpuid(1, &eax, &ebx, &ecx, &edx);
+    }
+    
+    if (!(edx & CPUID_EDX_FPU)) {
+        return; // No x87 unit, leave CR0.EM alone
+    }
+    
+    uint32_t cr0 = cpu_read_cr0();
+    cr0 &= ~(CR0_EM | CR0_TS);
+    cr0 |= CR0_MP;
+    cpu_write_cr0(cr0);
+    asm volatile("fninit");
+    features |= FPU_FEATURE_X87;
+    
+    if ((edx & CPUID_EDX_FXSR) && (edx & CPUID_EDX_SSE)) {
+        cpu_write_cr4(cpu_read_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT);
+        features |= FPU_FEATURE_FXSR | FPU_FEATURE_SSE;
+        
+        if (edx & CPUID_EDX_SSE2) {
+            features |= FPU_FEATURE_SSE2;
+            string_set_bulk_ops(sse2_memcpy, sse2_memset);
+        }
+    }
+}
+
+uint32_t fpu_get_features(void) {
+    return features;
+}
+
+// Clean register state for a new task
+void fpu_init_state(fpu_state_t* state) {
+    fpu_state_t current;
+    fpu_save(&current);
+    asm volatile("fninit");
+    fpu_save(state);
+    fpu_restore(&current);
+}
+
+void fpu_save(fpu_state_t* state) {
+    if (features & FPU_FEATURE_FXSR) {
+        asm volatile("fxsave %0" : "=m"(*state));
+    } else if (features & FPU_FEATURE_X87) {
+        // FNSAVE reinitializes the unit, reload to keep the state live
+        asm volatile("fnsave %0\n\t"
+                     "frstor %0"
+                     : "+m"(*state));
+    }
+}
+
+void fpu_restore(const fpu_state_t* state) {
+    if (features & FPU_FEATURE_FXSR) {
+        asm volatile("fxrstor %0" : : "m"(*state));
+    } else if (features & FPU_FEATURE_X87) {
+        asm volatile("frstor %0" : : "m"(*state));
+    }
+}
+
+// Eager switch: the scheduler calls this on every task switch so each
+// task always finds its own x87/SSE registers
+void fpu_switch(fpu_state_t* prev, const fpu_state_t* next) {
+    if (prev) {
+        fpu_save(prev);
+    }
+    if (next) {
+        fpu_restore(next);
+    }
+}
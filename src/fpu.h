@@ -0,0 +1,25 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+
+// Features enabled by fpu_init()
+#define FPU_FEATURE_X87   0x01
+#define FPU_FEATURE_FXSR  0x02
+#define FPU_FEATURE_SSE   0x04
+#define FPU_FEATURE_SSE2  0x08
+
+// Saved x87/SSE register state (FXSAVE area, also large enough for FNSAVE)
+typedef struct {
+    uint8_t data[512];
+} __attribute__((aligned(16))) fpu_state_t;
+
+// FPU/SSE functions
+void fpu_init(void);
+uint32_t fpu_get_features(void);
+void fpu_init_state(fpu_state_t* state);
+void fpu_save(fpu_state_t* state);
+void fpu_restore(const fpu_state_t* state);
+void fpu_switch(fpu_state_t* prev, const fpu_state_t* next);
+
+#endif // FPU_H
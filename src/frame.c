@@ -0,0 +1,185 @@
+#include "frame.h"
+#include "compositor.h"
+#include "pit.h"
+#include "cpu.h"
+#include "trace.h"
+
+// VGA input status register 1
+#define VGA_INPUT_STATUS    0x3DA
+#define VGA_RETRACE         0x08
+
+// PIT channel 2, used once as a calibration stopwatch
+#define PIT_CHANNEL2        0x42
+#define PIT_COMMAND         0x43
+#define PIT_CH2_ONESHOT     0xB0    // Channel 2, lobyte/hibyte, mode 0
+#define SPEAKER_PORT        0x61
+#define SPEAKER_GATE        0x01
+#define SPEAKER_DATA        0x02
+#define SPEAKER_OUT2        0x20
+
+#define CALIBRATE_MS        50
+// A real retrace at 50-85 Hz shows a handful of edges in the window;
+// emulated status bits that flip on every read show thousands
+#define VSYNC_MIN_EDGES     1
+#define VSYNC_MAX_EDGES     10
+
+static int sync_source = FRAME_SYNC_NONE;
+static uint32_t rate_hz = 0;
+static uint32_t cycles_per_us = 0;
+
+static uint64_t frame_start = 0;
+static uint32_t last_tick = 0;
+
+static uint32_t history[FRAME_HISTORY];
+static uint32_t history_sum = 0;
+static uint32_t frames = 0;
+static uint32_t last_us = 0;
+static uint32_t worst_us = 0;
+
+static int in_retrace(void) {
+    return (cpu_inb(VGA_INPUT_STATUS) & VGA_RETRACE) != 0;
+}
+
+// Run PIT channel 2 for CALIBRATE_MS, timing it with the TSC and counting
+// retrace edges on the way
+static uint32_t calibrate(uint32_t* edges) {
+    uint8_t speaker = cpu_inb(SPEAKER_PORT);
+    cpu_outb(SPEAKER_PORT, (speaker & ~SPEAKER_DATA) | SPEAKER_GATE);
+    
+    uint32_t count = PIT_BASE_HZ / (1000 / CALIBRATE_MS);
+    cpu_outb(PIT_COMMAND, PIT_CH2_ONESHOT);
+    cpu_outb(PIT_CHANNEL2, count & 0xFF);
+    cpu_outb(PIT_CHANNEL2, count >> 8);
+    
+    *edges = 0;
+    int was = in_retrace();
+    uint64_t start = cpu_rdtsc();
+    while (!(cpu_inb(SPEAKER_PORT) & SPEAKER_OUT2)) {
+        int now = in_retrace();
+        if (now && !was) (*edges)++;
+        was = now;
+    }
+    uint64_t cycles = cpu_rdtsc() - start;
+    
+    cpu_outb(SPEAKER_PORT, speaker);
+    return (uint32_t)cycles;
+}
+
+static void wait_retrace(void) {
+    while (in_retrace()) {
+    }
+    while (!in_retrace()) {
+    }
+}
+
+void frame_init(void) {
+    uint32_t edges;
+    uint32_t cycles = calibrate(&edges);
+    cycles_per_us = cycles / (CALIBRATE_MS * 1000);
+    if (cycles_per_us == 0) cycles_per_us = 1;
+    
+    if (edges >= VSYNC_MIN_EDGES && edges <= VSYNC_MAX_EDGES) {
+        // Time one full refresh to learn the rate
+        wait_retrace();
+        uint64_t start = cpu_rdtsc();
+        wait_retrace();
+        uint32_t period_us = (uint32_t)(cpu_rdtsc() - start) / cycles_per_us;
+        sync_source = FRAME_SYNC_VSYNC;
+        rate_hz = period_us ? 1000000 / period_us : 0;
+    } else {
+        sync_source = FRAME_SYNC_PIT;
+        rate_hz = FRAME_PIT_HZ;
+        if (!pit_is_running()) {
+            pit_start(FRAME_PIT_HZ, 0);
+        }
+        last_tick = pit_get_ticks();
+    }
+    frame_reset_stats();
+}
+
+void frame_begin(void) {
+    frame_start = cpu_rdtsc();
+}
+
+// Block until the next frame boundary
+static void frame_wait(void) {
+    if (sync_source == FRAME_SYNC_VSYNC) {
+        wait_retrace();
+        return;
+    }
+    if (sync_source != FRAME_SYNC_PIT) return;
+    
+    // The profiler may have reprogrammed or stopped the timer
+    if (!pit_is_running()) {
+        pit_start(FRAME_PIT_HZ, 0);
+        last_tick = pit_get_ticks();
+    }
+    uint32_t ticks_per_frame = pit_get_hz() / FRAME_PIT_HZ;
+    if (ticks_per_frame == 0) ticks_per_frame = 1;
+    
+    // Halt between ticks. sti only takes effect after the next instruction,
+    // so a tick cannot land between the check and the hlt and be missed
+    uint32_t flags = cpu_irq_save();
+    while (pit_get_ticks() - last_tick < ticks_per_frame) {
+        asm volatile("sti; hlt; cli" ::: "memory");
+    }
+    cpu_irq_restore(flags);
+    last_tick = pit_get_ticks();
+}
+
+void frame_present(void) {
+    uint64_t before_wait = cpu_rdtsc();
+    trace_event(TRACE_FRAME_WAIT_BEGIN, 0, 0);
+    frame_wait();
+    trace_event(TRACE_FRAME_WAIT_END, 0, 0);
+    uint64_t after_wait = cpu_rdtsc();
+    
+    compositor_flush();
+    
+    // Work before the wait plus the composition after it
+    uint64_t cycles = (before_wait - frame_start) + (cpu_rdtsc() - after_wait);
+    uint32_t us = cycles > 0xFFFFFFFFull ? 0xFFFFFFFF / cycles_per_us
+                                          : (uint32_t)cycles / cycles_per_us;
+    
+    uint32_t slot = frames % FRAME_HISTORY;
+    history_sum += us - history[slot];
+    history[slot] = us;
+    frames++;
+    last_us = us;
+    if (us > worst_us) worst_us = us;
+    
+    // Frames that skip frame_begin() are timed from here on
+    frame_start = cpu_rdtsc();
+}
+
+void frame_get_stats(frame_stats_t* stats) {
+    uint32_t count = frames < FRAME_HISTORY ? frames : FRAME_HISTORY;
+    stats->sync = sync_source;
+    stats->rate_hz = rate_hz;
+    stats->frames = frames;
+    stats->last_us = last_us;
+    stats->avg_us = count ? history_sum / count : 0;
+    stats->worst_us = worst_us;
+}
+
+void frame_reset_stats(void) {
+    for (int i = 0; i < FRAME_HISTORY; i++) {
+        history[i] = 0;
+    }
+    history_sum = 0;
+    frames = 0;
+    last_us = 0;
+    worst_us = 0;
+}
+
+const char* frame_sync_name(int sync) {
+    switch (sync) {
+        case FRAME_SYNC_VSYNC: return "vsync";
+        case FRAME_SYNC_PIT:   return "pit";
+        default:               return "none";
+    }
+}
+
+uint32_t frame_cycles_per_us(void) {
+    return cycles_per_us;
+}
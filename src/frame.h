@@ -0,0 +1,37 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+// Frame pacing sources
+#define FRAME_SYNC_NONE     0   // No usable timer, frames are not capped
+#define FRAME_SYNC_VSYNC    1   // VGA vertical retrace (input status port)
+#define FRAME_SYNC_PIT      2   // PIT ticks at FRAME_PIT_HZ
+
+#define FRAME_PIT_HZ        60
+#define FRAME_HISTORY       64  // Frames in the running average
+
+typedef struct {
+    int sync;
+    uint32_t rate_hz;       // Display (or tick) rate frames are capped at
+    uint32_t frames;        // Frames presented since the last reset
+    uint32_t last_us;       // Drawing + composition time, excluding the wait
+    uint32_t avg_us;        // Over the last FRAME_HISTORY frames
+    uint32_t worst_us;
+} frame_stats_t;
+
+// Frame functions
+// frame_init() calibrates the TSC against PIT channel 2 and checks whether
+// the retrace bit really follows the display. A frame starts with
+// frame_begin() before drawing; frame_present() waits for the next retrace
+// (or frame tick), composes the damage to the screen and accounts the
+// frame, so at most one frame reaches the screen per refresh
+void frame_init(void);
+void frame_begin(void);
+void frame_present(void);
+void frame_get_stats(frame_stats_t* stats);
+void frame_reset_stats(void);
+const char* frame_sync_name(int sync);
+uint32_t frame_cycles_per_us(void);     // TSC rate measured by frame_init()
+
+#endif // FRAME_H
@@ -1,28 +1,148 @@
 #include "fs.h"
 #include "string.h"
 #include "memory.h"
+#include "trace.h"
 
-// Maximum filesystem nodes
+// Maximum filesystem nodes (the host benchmark build raises these)
+#ifndef MAX_FS_NODES
 #define MAX_FS_NODES 64
+#endif
+#ifndef MAX_DIR_ENTRIES
 #define MAX_DIR_ENTRIES 32
+#endif
+
+// Name pool: a name's handle is its offset in name_pool plus one. The
+// hash table keeps handles and hashes side by side so a probe compares
+// integers and touches the pool's bytes only on a hash match. Nodes are
+// never deleted and a name is interned only once its node is certain to
+// be created, so the pool holds at most one name per node plus "pipe";
+// it is sized for all of them at full length and never runs out first
+#define FS_NAME_POOL_SIZE ((MAX_FS_NODES + 1) * (FS_NAME_MAX + 1))
+#define FS_NAME_SLOTS (MAX_FS_NODES * 2)
+
+static char name_pool[FS_NAME_POOL_SIZE];
+static uint32_t name_pool_used = 0;
+static uint32_t name_handles[FS_NAME_SLOTS];
+static uint32_t name_hashes[FS_NAME_SLOTS];
 
 // Simple in-memory filesystem (ramdisk)
-static fs_node_t fs_nodes[MAX_FS_NODES];
+// Nodes carry their VFS operations (fs_node_vfs_t starts with the fs_node_t)
+static fs_node_vfs_t fs_nodes[MAX_FS_NODES];
 static dirent_t dir_entries[MAX_FS_NODES][MAX_DIR_ENTRIES];
 static int fs_node_count = 0;
+static uint32_t next_inode = 1;
 static fs_node_t* current_directory = NULL;
 
 // Root filesystem node
-fs_node_t fs_root;
+fs_node_vfs_t fs_root;
+
+// Directory cursor: the next slot to look at in the directory's entries
+struct fs_dir {
+    fs_node_t* node;
+    uint32_t slot;
+    fs_dir_entry_t current;
+};
 
 // Sample file contents
 static char readme_content[] = "Welcome to ScooterOS!\n\nThis is a simple operating system with:\n- GUI interface\n- Memory management\n- File system\n- Command line interface\n\nPress F to toggle CLI mode.\nUse 'help' for available commands.";
 static char hello_content[] = "Hello, World!\nThis is a test file in the ScooterOS filesystem.\n\nYou can create, read, and delete files using the CLI.";
 static char system_info[] = "ScooterOS v1.0\nBuild: Debug\nArch: x86-32\nMemory: Dynamic allocation\nFilesystem: In-memory ramdisk";
 
+// /bin/test.exe: ELF32 image assembled from user/test.asm
+// (nasm -f bin user/test.asm -o test.exe), loaded by elf.c
+static uint8_t test_exe[] = {
+    0x7f, 0x45, 0x4c, 0x46, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x74, 0x80, 0x04, 0x08, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x34, 0x00, 0x20, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x04, 0x08, 0x00, 0x80, 0x04, 0x08, 0xc2, 0x00, 0x00, 0x00,
+    0xc2, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0xc4, 0x00, 0x00, 0x00, 0xc4, 0x90, 0x04, 0x08,
+    0xc4, 0x90, 0x04, 0x08, 0x04, 0x00, 0x00, 0x00, 0x40, 0x0f, 0x00, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0xb8, 0x01, 0x00, 0x00,
+    0x00, 0xbb, 0x01, 0x00, 0x00, 0x00, 0xbe, 0xa9, 0x80, 0x04, 0x08, 0xbf,
+    0x19, 0x00, 0x00, 0x00, 0xcd, 0x80, 0x8b, 0x1d, 0xc4, 0x90, 0x04, 0x08,
+    0x03, 0x1d, 0x00, 0xa0, 0x04, 0x08, 0xff, 0x05, 0xc4, 0x90, 0x04, 0x08,
+    0x89, 0x1d, 0x00, 0xa0, 0x04, 0x08, 0xb8, 0x00, 0x00, 0x00, 0x00, 0xcd,
+    0x80, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20,
+    0x2f, 0x62, 0x69, 0x6e, 0x2f, 0x74, 0x65, 0x73, 0x74, 0x2e, 0x65, 0x78,
+    0x65, 0x0a, 0x00, 0x00, 0x2a, 0x00, 0x00, 0x00,
+};
+
+// FNV-1a
+uint32_t fs_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding name, or the empty slot where it would go (-1 if the
+// table is full)
+static int find_name_slot(const char* name, uint32_t hash) {
+    uint32_t slot = hash % FS_NAME_SLOTS;
+    for (int probes = 0; probes < FS_NAME_SLOTS; probes++) {
+        if (name_handles[slot] == 0) {
+            return slot;
+        }
+        if (name_hashes[slot] == hash && strcmp(name_pool + name_handles[slot] - 1, name) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) % FS_NAME_SLOTS;
+    }
+    return -1;
+}
+
+// Handle of an already interned name, 0 if no node has ever used it
+static uint32_t lookup_name(const char* name, uint32_t hash) {
+    int slot = find_name_slot(name, hash);
+    return slot < 0 ? 0 : name_handles[slot];
+}
+
+// Handle for name, adding it to the pool if new; 0 if the name is longer
+// than FS_NAME_MAX or the pool is full
+uint32_t fs_intern_name(const char* name) {
+    if (!name || !*name || strlen(name) > FS_NAME_MAX) {
+        return 0;
+    }
+    
+    uint32_t hash = fs_name_hash(name);
+    int slot = find_name_slot(name, hash);
+    if (slot < 0) {
+        return 0;
+    }
+    if (name_handles[slot]) {
+        return name_handles[slot];
+    }
+    
+    uint32_t length = strlen(name) + 1;
+    if (length > FS_NAME_POOL_SIZE - name_pool_used) {
+        return 0;
+    }
+    memcpy(name_pool + name_pool_used, name, length);
+    name_handles[slot] = name_pool_used + 1;
+    name_hashes[slot] = hash;
+    name_pool_used += length;
+    return name_handles[slot];
+}
+
+const char* fs_name(uint32_t handle) {
+    if (handle == 0 || handle > name_pool_used) {
+        return "";
+    }
+    return name_pool + handle - 1;
+}
+
+// Give a node its interned name; fails if the name is too long
+static int set_name(uint32_t* handle, const char* name) {
+    *handle = fs_intern_name(name);
+    return *handle ? 0 : -1;
+}
+
 // Helper function to get next available inode
 static uint32_t get_next_inode() {
-    static uint32_t next_inode = 1;
     return next_inode++;
 }
 
@@ -34,7 +154,7 @@ static uint32_t get_current_time() {
 
 // Read from a ramdisk file
 static uint32_t read_ramdisk(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer) {
-    if (!node || !buffer || !(node->flags & FS_FILE)) {
+    if (!node || !buffer || FS_TYPE(node) != FS_FILE) {
         return 0;
     }
     
@@ -56,7 +176,7 @@ static uint32_t read_ramdisk(fs_node_t* node, uint32_t offset, uint32_t size, ui
 
 // Write to a ramdisk file
 static uint32_t write_ramdisk(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer) {
-    if (!node || !buffer || !(node->flags & FS_FILE)) {
+    if (!node || !buffer || FS_TYPE(node) != FS_FILE) {
         return 0;
     }
     
@@ -78,16 +198,24 @@ static uint32_t write_ramdisk(fs_node_t* node, uint32_t offset, uint32_t size, u
     return 0;
 }
 
+// Map a ramdisk file range: the bytes already sit in memory
+static const uint8_t* map_ramdisk(fs_node_t* node, uint32_t offset, uint32_t length) {
+    if (!node->ptr || offset > node->length || length > node->length - offset) {
+        return NULL;
+    }
+    return (const uint8_t*)node->ptr + offset;
+}
+
 // Read directory entries
 static dirent_t* readdir_ramdisk(fs_node_t* node, uint32_t index) {
-    if (!node || !(node->flags & FS_DIRECTORY)) {
+    if (!node || FS_TYPE(node) != FS_DIRECTORY) {
         return NULL;
     }
     
     // Count entries in this directory
     int entry_count = 0;
     for (int i = 0; i < MAX_DIR_ENTRIES; i++) {
-        if (dir_entries[node->inode][i].name[0] != '\0') {
+        if (dir_entries[node->inode][i].name) {
             if (entry_count == index) {
                 return &dir_entries[node->inode][i];
             }
@@ -98,34 +226,54 @@ static dirent_t* readdir_ramdisk(fs_node_t* node, uint32_t index) {
     return NULL;
 }
 
+// Nodes are allocated in inode order, so an inode indexes fs_nodes
+// directly; the root is served from its fs_root copy
+static fs_node_t* node_from_inode(uint32_t inode) {
+    if (inode == 0) {
+        return &fs_root.node;
+    }
+    if (inode < (uint32_t)fs_node_count && fs_nodes[inode].node.inode == inode) {
+        return &fs_nodes[inode].node;
+    }
+    return NULL;
+}
+
 // Find a file/directory by name
 static fs_node_t* finddir_ramdisk(fs_node_t* node, char* name) {
-    if (!node || !name || !(node->flags & FS_DIRECTORY)) {
+    if (!node || !name || FS_TYPE(node) != FS_DIRECTORY) {
+        return NULL;
+    }
+    
+    // A name that was never interned is in no directory; otherwise the
+    // entries are matched by handle
+    uint32_t handle = lookup_name(name, fs_name_hash(name));
+    if (!handle) {
         return NULL;
     }
     
-    // Search through directory entries
     for (int i = 0; i < MAX_DIR_ENTRIES; i++) {
-        if (dir_entries[node->inode][i].name[0] != '\0' && 
-            strcmp(dir_entries[node->inode][i].name, name) == 0) {
-            
-            uint32_t target_inode = dir_entries[node->inode][i].inode;
-            
-            // Find the node with this inode
-            for (int j = 0; j < fs_node_count; j++) {
-                if (fs_nodes[j].inode == target_inode) {
-                    return &fs_nodes[j];
-                }
-            }
+        if (dir_entries[node->inode][i].name == handle) {
+            return node_from_inode(dir_entries[node->inode][i].inode);
         }
     }
     
     return NULL;
 }
 
+static int mkdir_ramdisk(fs_node_t* parent, char* name);
+static int create_ramdisk(fs_node_t* parent, char* name);
+
+// Directory operations shared by every ramdisk directory
+static void set_directory_ops(fs_node_t* dir) {
+    ((fs_node_vfs_t*)dir)->readdir = &readdir_ramdisk;
+    ((fs_node_vfs_t*)dir)->finddir = &finddir_ramdisk;
+    ((fs_node_vfs_t*)dir)->mkdir = &mkdir_ramdisk;
+    ((fs_node_vfs_t*)dir)->create = &create_ramdisk;
+}
+
 // Create a directory
 static int mkdir_ramdisk(fs_node_t* parent, char* name) {
-    if (!parent || !name || !(parent->flags & FS_DIRECTORY) || fs_node_count >= MAX_FS_NODES) {
+    if (!parent || !name || FS_TYPE(parent) != FS_DIRECTORY || fs_node_count >= MAX_FS_NODES) {
         return -1;
     }
     
@@ -137,7 +285,7 @@ static int mkdir_ramdisk(fs_node_t* parent, char* name) {
     // Find empty slot in parent directory
     int dir_slot = -1;
     for (int i = 0; i < MAX_DIR_ENTRIES; i++) {
-        if (dir_entries[parent->inode][i].name[0] == '\0') {
+        if (dir_entries[parent->inode][i].name == 0) {
             dir_slot = i;
             break;
         }
@@ -148,8 +296,11 @@ static int mkdir_ramdisk(fs_node_t* parent, char* name) {
     }
     
     // Create new directory node
-    fs_node_t* new_dir = &fs_nodes[fs_node_count++];
-    strcpy(new_dir->name, name);
+    fs_node_t* new_dir = &fs_nodes[fs_node_count].node;
+    if (set_name(&new_dir->name, name) != 0) {
+        return -1; // Name too long
+    }
+    fs_node_count++;
     new_dir->flags = FS_DIRECTORY;
     new_dir->permissions = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
     new_dir->length = 0;
@@ -158,9 +309,10 @@ static int mkdir_ramdisk(fs_node_t* parent, char* name) {
     new_dir->modified_time = new_dir->created_time;
     new_dir->ptr = NULL;
     new_dir->parent = parent;
+    set_directory_ops(new_dir);
     
     // Add to parent directory
-    strcpy(dir_entries[parent->inode][dir_slot].name, name);
+    dir_entries[parent->inode][dir_slot].name = new_dir->name;
     dir_entries[parent->inode][dir_slot].inode = new_dir->inode;
     dir_entries[parent->inode][dir_slot].type = FS_DIRECTORY;
     
@@ -169,7 +321,7 @@ static int mkdir_ramdisk(fs_node_t* parent, char* name) {
 
 // Create a file
 static int create_ramdisk(fs_node_t* parent, char* name) {
-    if (!parent || !name || !(parent->flags & FS_DIRECTORY) || fs_node_count >= MAX_FS_NODES) {
+    if (!parent || !name || FS_TYPE(parent) != FS_DIRECTORY || fs_node_count >= MAX_FS_NODES) {
         return -1;
     }
     
@@ -181,7 +333,7 @@ static int create_ramdisk(fs_node_t* parent, char* name) {
     // Find empty slot in parent directory
     int dir_slot = -1;
     for (int i = 0; i < MAX_DIR_ENTRIES; i++) {
-        if (dir_entries[parent->inode][i].name[0] == '\0') {
+        if (dir_entries[parent->inode][i].name == 0) {
             dir_slot = i;
             break;
         }
@@ -192,8 +344,11 @@ static int create_ramdisk(fs_node_t* parent, char* name) {
     }
     
     // Create new file node
-    fs_node_t* new_file = &fs_nodes[fs_node_count++];
-    strcpy(new_file->name, name);
+    fs_node_t* new_file = &fs_nodes[fs_node_count].node;
+    if (set_name(&new_file->name, name) != 0) {
+        return -1; // Name too long
+    }
+    fs_node_count++;
     new_file->flags = FS_FILE;
     new_file->permissions = FS_PERM_READ | FS_PERM_WRITE;
     new_file->length = 0;
@@ -204,16 +359,16 @@ static int create_ramdisk(fs_node_t* parent, char* name) {
     new_file->parent = parent;
     
     // Add to parent directory
-    strcpy(dir_entries[parent->inode][dir_slot].name, name);
+    dir_entries[parent->inode][dir_slot].name = new_file->name;
     dir_entries[parent->inode][dir_slot].inode = new_file->inode;
     dir_entries[parent->inode][dir_slot].type = FS_FILE;
     
     return 0;
 }
 
-// Helper function to create a file with content
-static fs_node_t* create_file_with_content(fs_node_t* parent, char* name, char* content) {
-    if (!parent || !name || !content) {
+// Helper function to create a file backed by length bytes at data
+static fs_node_t* create_file_with_data(fs_node_t* parent, char* name, uint8_t* data, uint32_t length) {
+    if (!parent || !name || !data) {
         return NULL;
     }
     
@@ -223,27 +378,39 @@ static fs_node_t* create_file_with_content(fs_node_t* parent, char* name, char*
     
     fs_node_t* file = finddir_ramdisk(parent, name);
     if (file) {
-        file->length = strlen(content);
-        file->ptr = (struct fs_node*)content;
+        file->length = length;
+        file->ptr = (struct fs_node*)data;
         
         // Set up VFS function pointers
         ((fs_node_vfs_t*)file)->read = &read_ramdisk;
         ((fs_node_vfs_t*)file)->write = &write_ramdisk;
+        ((fs_node_vfs_t*)file)->map = &map_ramdisk;
     }
     
     return file;
 }
 
+// Helper function to create a file with text content
+static fs_node_t* create_file_with_content(fs_node_t* parent, char* name, char* content) {
+    if (!content) {
+        return NULL;
+    }
+    return create_file_with_data(parent, name, (uint8_t*)content, strlen(content));
+}
+
 // Initialize the filesystem
 void fs_init() {
     // Clear all nodes and directory entries
     memset(fs_nodes, 0, sizeof(fs_nodes));
     memset(dir_entries, 0, sizeof(dir_entries));
+    memset(name_handles, 0, sizeof(name_handles));
+    name_pool_used = 0;
     fs_node_count = 0;
+    next_inode = 1;
     
     // Root directory
-    fs_node_t* root = &fs_nodes[fs_node_count++];
-    strcpy(root->name, "/");
+    fs_node_t* root = &fs_nodes[fs_node_count++].node;
+    set_name(&root->name, "/");
     root->flags = FS_DIRECTORY;
     root->permissions = FS_PERM_READ | FS_PERM_WRITE | FS_PERM_EXEC;
     root->length = 0;
@@ -254,48 +421,37 @@ void fs_init() {
     root->parent = NULL;
     
     // Set up VFS function pointers for root
-    ((fs_node_vfs_t*)root)->readdir = &readdir_ramdisk;
-    ((fs_node_vfs_t*)root)->finddir = &finddir_ramdisk;
-    ((fs_node_vfs_t*)root)->mkdir = &mkdir_ramdisk;
-    ((fs_node_vfs_t*)root)->create = &create_ramdisk;
+    set_directory_ops(root);
     
     // Copy root to global
-    fs_root = *root;
-    current_directory = &fs_root;
+    fs_root = *(fs_node_vfs_t*)root;
+    current_directory = &fs_root.node;
     
     // Create some sample files and directories
-    create_file_with_content(&fs_root, "readme.txt", readme_content);
-    create_file_with_content(&fs_root, "hello.txt", hello_content);
-    create_file_with_content(&fs_root, "system.info", system_info);
+    create_file_with_content(&fs_root.node, "readme.txt", readme_content);
+    create_file_with_content(&fs_root.node, "hello.txt", hello_content);
+    create_file_with_content(&fs_root.node, "system.info", system_info);
     
     // Create a documents directory
-    mkdir_ramdisk(&fs_root, "documents");
-    fs_node_t* docs_dir = finddir_ramdisk(&fs_root, "documents");
+    mkdir_ramdisk(&fs_root.node, "documents");
+    fs_node_t* docs_dir = finddir_ramdisk(&fs_root.node, "documents");
     if (docs_dir) {
-        // Set up VFS function pointers for documents directory
-        ((fs_node_vfs_t*)docs_dir)->readdir = &readdir_ramdisk;
-        ((fs_node_vfs_t*)docs_dir)->finddir = &finddir_ramdisk;
-        ((fs_node_vfs_t*)docs_dir)->mkdir = &mkdir_ramdisk;
-        ((fs_node_vfs_t*)docs_dir)->create = &create_ramdisk;
-        
         create_file_with_content(docs_dir, "notes.txt", "Personal notes file.\nYou can write your thoughts here.");
     }
     
     // Create a bin directory
-    mkdir_ramdisk(&fs_root, "bin");
-    fs_node_t* bin_dir = finddir_ramdisk(&fs_root, "bin");
+    mkdir_ramdisk(&fs_root.node, "bin");
+    fs_node_t* bin_dir = finddir_ramdisk(&fs_root.node, "bin");
     if (bin_dir) {
-        ((fs_node_vfs_t*)bin_dir)->readdir = &readdir_ramdisk;
-        ((fs_node_vfs_t*)bin_dir)->finddir = &finddir_ramdisk;
-        ((fs_node_vfs_t*)bin_dir)->mkdir = &mkdir_ramdisk;
-        ((fs_node_vfs_t*)bin_dir)->create = &create_ramdisk;
-        
-        create_file_with_content(bin_dir, "test.exe", "Mock executable file");
+        fs_node_t* test = create_file_with_data(bin_dir, "test.exe", test_exe, sizeof(test_exe));
+        if (test) {
+            test->permissions |= FS_PERM_EXEC;
+        }
     }
 }
 
-// Find a file by relative path
-fs_node_t* fs_find(char* path) {
+// Resolve a path relative to the current directory
+static fs_node_t* find_path(char* path) {
     if (!path) {
         return NULL;
     }
@@ -304,7 +460,7 @@ fs_node_t* fs_find(char* path) {
     
     // Handle absolute paths
     if (path[0] == '/') {
-        current = &fs_root;
+        current = &fs_root.node;
         path++;
     }
     
@@ -350,13 +506,21 @@ fs_node_t* fs_find(char* path) {
     return current;
 }
 
+// Find a file by relative path
+fs_node_t* fs_find(char* path) {
+    trace_event(TRACE_FS_FIND_BEGIN, 0, 0);
+    fs_node_t* node = find_path(path);
+    trace_event(TRACE_FS_FIND_END, (uint32_t)(uintptr_t)node, 0);
+    return node;
+}
+
 // Find a file by absolute path
 fs_node_t* fs_find_absolute(char* path) {
     if (!path || path[0] != '/') {
         return NULL;
     }
     
-    fs_node_t* current = &fs_root;
+    fs_node_t* current = &fs_root.node;
     path++; // Skip leading '/'
     
     if (*path == '\0') {
@@ -392,7 +556,10 @@ uint32_t fs_read(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffe
     if (!node || ((fs_node_vfs_t*)node)->read == NULL) {
         return 0;
     }
-    return ((fs_node_vfs_t*)node)->read(node, offset, size, buffer);
+    trace_event(TRACE_FS_READ_BEGIN, node->inode, size);
+    uint32_t done = ((fs_node_vfs_t*)node)->read(node, offset, size, buffer);
+    trace_event(TRACE_FS_READ_END, done, 0);
+    return done;
 }
 
 // Write to a file
@@ -400,15 +567,90 @@ uint32_t fs_write(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buff
     if (!node || ((fs_node_vfs_t*)node)->write == NULL) {
         return 0;
     }
-    return ((fs_node_vfs_t*)node)->write(node, offset, size, buffer);
+    trace_event(TRACE_FS_WRITE_BEGIN, node->inode, size);
+    uint32_t done = ((fs_node_vfs_t*)node)->write(node, offset, size, buffer);
+    trace_event(TRACE_FS_WRITE_END, done, 0);
+    return done;
+}
+
+// Direct read-only pointer to length bytes at offset, or NULL if the node
+// has no in-memory storage or the range is not inside the file. The
+// bytes change in place when the file is written
+const uint8_t* fs_map(fs_node_t* node, uint32_t offset, uint32_t length) {
+    if (!node || ((fs_node_vfs_t*)node)->map == NULL) {
+        return NULL;
+    }
+    return ((fs_node_vfs_t*)node)->map(node, offset, length);
+}
+
+// Next chunk for a streaming reader: *size bytes at most (the buffer's
+// size) on entry, the chunk's size on return, 0 at the end. A file's
+// bytes come in place through fs_map() when it has them, clamped to its
+// length; anything else (a pipe has no length) is read into buffer
+const uint8_t* fs_read_chunk(fs_node_t* node, uint32_t offset, uint8_t* buffer, uint32_t* size) {
+    if (FS_TYPE(node) == FS_FILE) {
+        if (offset >= node->length) {
+            *size = 0;
+            return buffer;
+        }
+        if (node->length - offset < *size) *size = node->length - offset;
+        const uint8_t* data = fs_map(node, offset, *size);
+        if (data) return data;
+    }
+    *size = fs_read(node, offset, *size, buffer);
+    return buffer;
 }
 
 // Read a directory
 dirent_t* fs_readdir(fs_node_t* node, uint32_t index) {
-    if (!node || !(node->flags & FS_DIRECTORY) || ((fs_node_vfs_t*)node)->readdir == NULL) {
+    if (!node || FS_TYPE(node) != FS_DIRECTORY || ((fs_node_vfs_t*)node)->readdir == NULL) {
+        return NULL;
+    }
+    trace_event(TRACE_FS_READDIR_BEGIN, node->inode, index);
+    dirent_t* entry = ((fs_node_vfs_t*)node)->readdir(node, index);
+    trace_event(TRACE_FS_READDIR_END, (uint32_t)(uintptr_t)entry, 0);
+    return entry;
+}
+
+// Open a cursor over a directory's entries. Each fs_readdir_next() step
+// resumes where the last one stopped, so a full listing is one pass
+// instead of the rescan per index that fs_readdir() does
+fs_dir_t* fs_opendir(fs_node_t* node) {
+    if (!node || FS_TYPE(node) != FS_DIRECTORY || ((fs_node_vfs_t*)node)->readdir != &readdir_ramdisk) {
+        return NULL;
+    }
+    
+    fs_dir_t* dir = (fs_dir_t*)malloc(sizeof(fs_dir_t));
+    if (!dir) {
         return NULL;
     }
-    return ((fs_node_vfs_t*)node)->readdir(node, index);
+    dir->node = node;
+    dir->slot = 0;
+    return dir;
+}
+
+// Next entry, or NULL at the end. The result is overwritten by the next
+// call on the same cursor
+fs_dir_entry_t* fs_readdir_next(fs_dir_t* dir) {
+    if (!dir) {
+        return NULL;
+    }
+    
+    dirent_t* entries = dir_entries[dir->node->inode];
+    while (dir->slot < MAX_DIR_ENTRIES) {
+        dirent_t* entry = &entries[dir->slot++];
+        if (entry->name) {
+            dir->current.entry = entry;
+            dir->current.node = node_from_inode(entry->inode);
+            dir->current.type = entry->type;
+            return &dir->current;
+        }
+    }
+    return NULL;
+}
+
+void fs_closedir(fs_dir_t* dir) {
+    free(dir);
 }
 
 // Create a directory
@@ -416,11 +658,14 @@ int fs_mkdir(fs_node_t* parent, char* name) {
     if (!parent || !name || ((fs_node_vfs_t*)parent)->mkdir == NULL) {
         return -1;
     }
-    return ((fs_node_vfs_t*)parent)->mkdir(parent, name);
+    trace_event(TRACE_FS_MKDIR_BEGIN, parent->inode, 0);
+    int result = ((fs_node_vfs_t*)parent)->mkdir(parent, name);
+    trace_event(TRACE_FS_MKDIR_END, result, 0);
+    return result;
 }
 
 // Create a file with content
-int fs_create_file(fs_node_t* parent, char* name, char* content) {
+static int create_file(fs_node_t* parent, char* name, char* content) {
     if (!parent || !name) {
         return -1;
     }
@@ -442,6 +687,7 @@ int fs_create_file(fs_node_t* parent, char* name, char* content) {
                 // Set up VFS function pointers
                 ((fs_node_vfs_t*)file)->read = &read_ramdisk;
                 ((fs_node_vfs_t*)file)->write = &write_ramdisk;
+                ((fs_node_vfs_t*)file)->map = &map_ramdisk;
             }
         }
     }
@@ -449,15 +695,22 @@ int fs_create_file(fs_node_t* parent, char* name, char* content) {
     return 0;
 }
 
+int fs_create_file(fs_node_t* parent, char* name, char* content) {
+    trace_event(TRACE_FS_CREATE_BEGIN, parent ? parent->inode : 0, 0);
+    int result = create_file(parent, name, content);
+    trace_event(TRACE_FS_CREATE_END, result, 0);
+    return result;
+}
+
 // Get filesystem statistics
 fs_stats_t fs_get_stats() {
     fs_stats_t stats = {0};
     
     for (int i = 0; i < fs_node_count; i++) {
-        if (fs_nodes[i].flags & FS_FILE) {
+        if (FS_TYPE(&fs_nodes[i].node) == FS_FILE) {
             stats.total_files++;
-            stats.total_size += fs_nodes[i].length;
-        } else if (fs_nodes[i].flags & FS_DIRECTORY) {
+            stats.total_size += fs_nodes[i].node.length;
+        } else if (FS_TYPE(&fs_nodes[i].node) == FS_DIRECTORY) {
             stats.total_directories++;
         }
     }
@@ -474,12 +727,12 @@ fs_node_t* fs_get_current_directory() {
 
 // Get the root directory
 fs_node_t* get_root_directory() {
-    return &fs_root;
+    return &fs_root.node;
 }
 
 // Set current directory
 void fs_set_current_directory(fs_node_t* dir) {
-    if (dir && (dir->flags & FS_DIRECTORY)) {
+    if (dir && FS_TYPE(dir) == FS_DIRECTORY) {
         current_directory = dir;
     }
 }
@@ -505,13 +758,13 @@ char* fs_get_current_path() {
     }
     
     // Build path string
-    if (depth == 1 && nodes[0] == &fs_root) {
+    if (depth == 1 && nodes[0] == &fs_root.node) {
         strcpy(path_buffer, "/");
     } else {
         for (int i = depth - 1; i >= 0; i--) {
-            if (nodes[i] != &fs_root) {
+            if (nodes[i] != &fs_root.node) {
                 strcat(path_buffer, "/");
-                strcat(path_buffer, nodes[i]->name);
+                strcat(path_buffer, fs_name(nodes[i]->name));
             }
         }
         if (path_buffer[0] == '\0') {
@@ -526,19 +779,21 @@ char* fs_get_current_path() {
 char* fs_get_file_type_string(fs_node_t* node) {
     if (!node) return "unknown";
     
-    if (node->flags & FS_DIRECTORY) return "directory";
-    if (node->flags & FS_FILE) return "file";
-    if (node->flags & FS_CHARDEVICE) return "char device";
-    if (node->flags & FS_BLOCKDEVICE) return "block device";
-    if (node->flags & FS_PIPE) return "pipe";
-    if (node->flags & FS_SYMLINK) return "symlink";
+    switch (FS_TYPE(node)) {
+    case FS_DIRECTORY: return "directory";
+    case FS_FILE: return "file";
+    case FS_CHARDEVICE: return "char device";
+    case FS_BLOCKDEVICE: return "block device";
+    case FS_PIPE: return "pipe";
+    case FS_SYMLINK: return "symlink";
+    }
     
     return "unknown";
 }
 
 // Check if filename is valid
 int fs_is_valid_filename(char* name) {
-    if (!name || strlen(name) == 0 || strlen(name) > 127) {
+    if (!name || strlen(name) == 0 || strlen(name) > FS_NAME_MAX) {
         return 0;
     }
     
@@ -15,6 +15,14 @@ struct fs_node;
 #define FS_SYMLINK     0x06
 #define FS_MOUNTPOINT  0x08
 
+// The low bits hold the node type (a value, not a set of bits: FS_PIPE
+// shares FS_FILE's bit); FS_MOUNTPOINT may be or-ed on top
+#define FS_TYPE_MASK   0x07
+#define FS_TYPE(node)  ((node)->flags & FS_TYPE_MASK)
+
+// Longest name a node can have, not counting the terminator
+#define FS_NAME_MAX    127
+
 // File permissions
 #define FS_PERM_READ   0x01
 #define FS_PERM_WRITE  0x02
@@ -22,7 +30,7 @@ struct fs_node;
 
 // Filesystem node structure
 typedef struct fs_node {
-    char name[128];
+    uint32_t name;          // Interned name handle (fs_name())
     uint32_t flags;
     uint32_t permissions;
     uint32_t length;
@@ -35,11 +43,22 @@ typedef struct fs_node {
 
 // Directory entry structure
 typedef struct dirent {
-    char name[128];
+    uint32_t name;          // Interned name handle, 0 for a free slot
     uint32_t inode;
     uint8_t type;
 } dirent_t;
 
+// Opaque directory cursor (fs_opendir)
+typedef struct fs_dir fs_dir_t;
+
+// What fs_readdir_next() returns: the entry, the node it names and its
+// type, so callers need no lookup per entry
+typedef struct fs_dir_entry {
+    dirent_t* entry;
+    fs_node_t* node;
+    uint8_t type;
+} fs_dir_entry_t;
+
 // File system statistics
 typedef struct fs_stats {
     uint32_t total_files;
@@ -51,6 +70,7 @@ typedef struct fs_stats {
 // Function pointers for VFS
 typedef uint32_t (*read_type_t)(fs_node_t*, uint32_t, uint32_t, uint8_t*);
 typedef uint32_t (*write_type_t)(fs_node_t*, uint32_t, uint32_t, uint8_t*);
+typedef const uint8_t* (*map_type_t)(fs_node_t*, uint32_t, uint32_t);
 typedef void (*open_type_t)(fs_node_t*);
 typedef void (*close_type_t)(fs_node_t*);
 typedef dirent_t* (*readdir_type_t)(fs_node_t*, uint32_t);
@@ -65,6 +85,7 @@ typedef struct fs_node_vfs {
     fs_node_t node;
     read_type_t read;
     write_type_t write;
+    map_type_t map;
     open_type_t open;
     close_type_t close;
     readdir_type_t readdir;
@@ -82,7 +103,12 @@ fs_node_t* fs_find(char* path);
 fs_node_t* fs_find_absolute(char* path);
 uint32_t fs_read(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer);
 uint32_t fs_write(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer);
+const uint8_t* fs_map(fs_node_t* node, uint32_t offset, uint32_t length);
+const uint8_t* fs_read_chunk(fs_node_t* node, uint32_t offset, uint8_t* buffer, uint32_t* size);
 dirent_t* fs_readdir(fs_node_t* node, uint32_t index);
+fs_dir_t* fs_opendir(fs_node_t* node);
+fs_dir_entry_t* fs_readdir_next(fs_dir_t* dir);
+void fs_closedir(fs_dir_t* dir);
 int fs_mkdir(fs_node_t* parent, char* name);
 int fs_create_file(fs_node_t* parent, char* name, char* content);
 int fs_delete(fs_node_t* parent, char* name);
@@ -91,6 +117,12 @@ char* fs_get_current_path();
 void fs_set_current_directory(fs_node_t* dir);
 fs_node_t* fs_get_current_directory();
 
+// Interned names: each distinct name is stored once, so two names are
+// equal exactly when their handles are. Handle 0 is the empty name
+uint32_t fs_name_hash(const char* name);
+uint32_t fs_intern_name(const char* name);
+const char* fs_name(uint32_t handle);
+
 // Utility functions
 void fs_print_tree(fs_node_t* node, int depth);
 int fs_is_valid_filename(char* name);
@@ -0,0 +1,121 @@
+#include "gdt.h"
+#include "string.h"
+#include "cpu.h"
+
+#define GDT_ENTRIES         7
+#define DOUBLE_FAULT_STACK_SIZE 8192
+
+// Access bytes
+#define GDT_KERNEL_CODE     0x9A    // Present, ring 0, code, readable
+#define GDT_KERNEL_DATA     0x92    // Present, ring 0, data, writable
+#define GDT_USER_CODE       0xFA
+#define GDT_USER_DATA       0xF2
+#define GDT_TSS             0x89    // Present, 32-bit available TSS
+#define GDT_FLAT_4G         0xCF    // 4KB granularity, 32-bit, limit 0xFFFFF
+#define EFLAGS_RESERVED     0x02    // Bit 1 always reads as set
+
+typedef struct {
+    uint16_t limit_low;
+    uint16_t base_low;
+    uint8_t base_mid;
+    uint8_t access;
+    uint8_t granularity;
+    uint8_t base_high;
+} __attribute__((packed)) gdt_entry_t;
+
+typedef struct {
+    uint16_t limit;
+    uint32_t base;
+} __attribute__((packed)) gdt_descriptor_t;
+
+// The kernel TSS only provides ss0/esp0 (the stack for entering ring 0);
+// the double fault TSS is the one hardware task switch target. Neither
+// has an I/O permission bitmap
+typedef struct {
+    uint32_t prev_task;
+    uint32_t esp0, ss0;
+    uint32_t esp1, ss1;
+    uint32_t esp2, ss2;
+    uint32_t cr3, eip, eflags;
+    uint32_t eax, ecx, edx, ebx, esp, ebp, esi, edi;
+    uint32_t es, cs, ss, ds, fs, gs;
+    uint32_t ldt;
+    uint16_t trap;
+    uint16_t iomap_base;
+} __attribute__((packed)) tss_t;
+
+static gdt_entry_t gdt[GDT_ENTRIES] __attribute__((aligned(8)));
+static tss_t tss;
+static tss_t double_fault_tss;
+static uint8_t double_fault_stack[DOUBLE_FAULT_STACK_SIZE] __attribute__((aligned(16)));
+
+static void gdt_set_entry(int index, uint32_t base, uint32_t limit, uint8_t access, uint8_t granularity) {
+    gdt[index].limit_low = limit & 0xFFFF;
+    gdt[index].base_low = base & 0xFFFF;
+    gdt[index].base_mid = (base >> 16) & 0xFF;
+    gdt[index].access = access;
+    gdt[index].granularity = (granularity & 0xF0) | ((limit >> 16) & 0x0F);
+    gdt[index].base_high = base >> 24;
+}
+
+void gdt_init(void) {
+    memset(&tss, 0, sizeof(tss));
+    tss.ss0 = KERNEL_DATA_SEG;
+    tss.iomap_base = sizeof(tss);
+    
+    gdt_set_entry(0, 0, 0, 0, 0);
+    gdt_set_entry(KERNEL_CODE_SEG >> 3, 0, 0xFFFFF, GDT_KERNEL_CODE, GDT_FLAT_4G);
+    gdt_set_entry(KERNEL_DATA_SEG >> 3, 0, 0xFFFFF, GDT_KERNEL_DATA, GDT_FLAT_4G);
+    gdt_set_entry(USER_CODE_SEG >> 3, 0, 0xFFFFF, GDT_USER_CODE, GDT_FLAT_4G);
+    gdt_set_entry(USER_DATA_SEG >> 3, 0, 0xFFFFF, GDT_USER_DATA, GDT_FLAT_4G);
+    gdt_set_entry(TSS_SEG >> 3, (uint32_t)(uintptr_t)&tss, sizeof(tss) - 1, GDT_TSS, 0);
+    gdt_set_entry(DOUBLE_FAULT_TSS_SEG >> 3, (uint32_t)(uintptr_t)&double_fault_tss,
+                  sizeof(double_fault_tss) - 1, GDT_TSS, 0);
+    
+    gdt_descriptor_t descriptor;
+    descriptor.limit = sizeof(gdt) - 1;
+    descriptor.base = (uint32_t)(uintptr_t)gdt;
+    asm volatile("lgdt %0\n\t"
+                 "ljmp %1, $1f\n"
+                 "1:\n\t"
+                 "movw %2, %%ax\n\t"
+                 "movw %%ax, %%ds\n\t"
+                 "movw %%ax, %%es\n\t"
+                 "movw %%ax, %%fs\n\t"
+                 "movw %%ax, %%gs\n\t"
+                 "movw %%ax, %%ss"
+                 : : "m"(descriptor), "i"(KERNEL_CODE_SEG), "i"(KERNEL_DATA_SEG)
+                 : "eax", "memory");
+    asm volatile("ltr %w0" : : "r"(TSS_SEG));
+}
+
+// Stack the CPU switches to when an interrupt or int 0x80 leaves ring 3
+void gdt_set_kernel_stack(uint32_t esp0) {
+    tss.esp0 = esp0;
+}
+
+// Interrupts stay off in the double fault task; the CPU pushes the error
+// code onto its stack where a return address would be
+void gdt_set_double_fault_task(void (*entry)(void)) {
+    memset(&double_fault_tss, 0, sizeof(double_fault_tss));
+    double_fault_tss.cr3 = cpu_read_cr3();
+    double_fault_tss.eip = (uint32_t)(uintptr_t)entry;
+    double_fault_tss.eflags = EFLAGS_RESERVED;
+    double_fault_tss.esp = (uint32_t)(uintptr_t)(double_fault_stack + DOUBLE_FAULT_STACK_SIZE);
+    double_fault_tss.cs = KERNEL_CODE_SEG;
+    double_fault_tss.ss = double_fault_tss.ds = double_fault_tss.es = KERNEL_DATA_SEG;
+    double_fault_tss.fs = double_fault_tss.gs = KERNEL_DATA_SEG;
+    double_fault_tss.iomap_base = sizeof(double_fault_tss);
+}
+
+// A task switch loads CR3 from the new TSS, so it must follow paging_init()
+void gdt_set_page_directory(uint32_t cr3) {
+    double_fault_tss.cr3 = cr3;
+}
+
+// Where the kernel was when it double faulted: the switch saved its
+// registers into the kernel TSS
+void gdt_get_fault_context(uint32_t* eip, uint32_t* esp) {
+    *eip = tss.eip;
+    *esp = tss.esp;
+}
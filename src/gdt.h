@@ -0,0 +1,28 @@
+#ifndef GDT_H
+#define GDT_H
+
+#include <stdint.h>
+
+// Segment selectors. The kernel pair keeps stage2.asm's values; SYSENTER
+// and SYSEXIT need the four code/data selectors in exactly this order
+#define KERNEL_CODE_SEG     0x08
+#define KERNEL_DATA_SEG     0x10
+#define USER_CODE_SEG       0x1B    // Ring 3 (RPL 3)
+#define USER_DATA_SEG       0x23
+#define TSS_SEG             0x28
+#define DOUBLE_FAULT_TSS_SEG 0x30   // Task gate target for vector 8
+
+// GDT functions
+// gdt_init() replaces the boot GDT with one that adds ring 3 segments and
+// a TSS, reloads every segment register and loads the task register
+void gdt_init(void);
+void gdt_set_kernel_stack(uint32_t esp0);
+
+// A double fault switches tasks (vector 8 is a task gate) onto a TSS with
+// its own stack, so it is still reported when the kernel stack itself is
+// what faulted. entry must never return
+void gdt_set_double_fault_task(void (*entry)(void));
+void gdt_set_page_directory(uint32_t cr3);
+void gdt_get_fault_context(uint32_t* eip, uint32_t* esp);
+
+#endif // GDT_H
@@ -1,47 +1,193 @@
 #include "gui.h"
 #include "string.h"
+#include "trace.h"
+#include "memory.h"
+#include "bootlog.h"
 
-// Simple font data (8x8 pixels per character, simplified)
-static const unsigned char font_data[256][8] = {
-    // Space (32)
-    [32] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
-    // A (65)
-    [65] = {0x18, 0x24, 0x42, 0x7E, 0x42, 0x42, 0x42, 0x00},
-    // Add more characters as needed...
-    // For now, we'll use a simple pattern for all printable characters
-};
+// There is no font yet: every printable character is drawn as the same
+// 8x8 box. Bit 7 of a glyph row is its leftmost pixel
+#define GLYPH_SIZE 8
+
+static uint8_t glyph_row(unsigned char ch, int row) {
+    if (ch < 32 || ch > 126) return 0;
+    return (row == 1 || row == 6) ? 0xFF : 0x42;
+}
+
+// Drawing goes to gui_target, the screen unless redirected. The screen is
+// mode 13h until gui_init_screen() reads the mode stage 2 picked
+static surface_t gui_screen = { VGA_FRAMEBUFFER, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH, SURFACE_8BPP };
+static surface_t* gui_target = &gui_screen;
+
+// The static desktop is rendered once into this 8bpp cache (screen sized,
+// allocated at init); leaving the CLI copies back only the rect it covered
+// instead of repainting everything
+static surface_t desktop_cache;
+static int desktop_valid = 0;
+
+surface_t* gui_screen_surface(void) {
+    return &gui_screen;
+}
+
+surface_t* gui_set_target(surface_t* target) {
+    surface_t* previous = gui_target;
+    gui_target = target ? target : &gui_screen;
+    return previous;
+}
+
+// Adopt the framebuffer described in the boot information block
+static void gui_init_screen(void) {
+    const volatile boot_info_t* info = boot_info();
+    if (info->magic != BOOT_INFO_MAGIC || info->fb_addr == 0) return;
+    if (info->fb_bpp != SURFACE_8BPP && info->fb_bpp != SURFACE_32BPP) return;
+    
+    surface_init(&gui_screen, (uint8_t*)(uintptr_t)info->fb_addr,
+                 info->fb_width, info->fb_height, info->fb_pitch, info->fb_bpp);
+}
 
 void init_gui_system(void) {
     // Initialize GUI system
-    asm_clear_screen(COLOR_BLUE);
+    gui_init_screen();
+    
+    int size = gui_screen.width * gui_screen.height;
+    uint8_t* pixels = malloc(size);
+    if (pixels) {
+        surface_init(&desktop_cache, pixels, gui_screen.width, gui_screen.height,
+                     gui_screen.width, SURFACE_8BPP);
+    }
+    
+    gui_clear_framebuffer(COLOR_BLUE);
 }
 
+// Loading bar geometry
+#define LOADING_BAR_X      60
+#define LOADING_BAR_Y      110
+#define LOADING_BAR_WIDTH  200
+#define LOADING_BAR_HEIGHT 12
+
 void show_loading_screen(void) {
-    asm_clear_screen(COLOR_BLACK);
+    gui_clear_framebuffer(COLOR_BLACK);
     draw_text(100, 90, "Loading ScooterOS...", COLOR_WHITE);
+    draw_rectangle(LOADING_BAR_X, LOADING_BAR_Y, LOADING_BAR_WIDTH, LOADING_BAR_HEIGHT, COLOR_GRAY);
+#ifndef FAST_BOOT
     asm_delay(100000);
+#endif
 }
 
-void show_desktop(void) {
-    asm_clear_screen(COLOR_BLUE);
+// Fill the loading bar to reflect completed init stages
+void show_loading_progress(int done, int total) {
+    if (total <= 0) return;
+    if (done > total) done = total;
+
+    int inner = LOADING_BAR_WIDTH - 2;
+    int width = inner * done / total;
+    draw_filled_rectangle(LOADING_BAR_X + 1, LOADING_BAR_Y + 1, width, LOADING_BAR_HEIGHT - 2, COLOR_GREEN);
+}
+
+// Taskbar and icons, matching draw_taskbar/draw_desktop_icons in kernel.asm
+#define TASKBAR_HEIGHT  25
+
+static void draw_taskbar(void) {
+    int width = gui_target->width;
+    int y = gui_target->height - TASKBAR_HEIGHT;
+    draw_filled_rectangle(0, y, width, TASKBAR_HEIGHT, COLOR_DARK_GRAY);
+    draw_filled_rectangle(0, y, width, 1, COLOR_LWHITE);
+    draw_filled_rectangle(0, y + TASKBAR_HEIGHT - 1, width, 1, COLOR_BLACK);
+    
+    // Start button and separator
+    draw_filled_rectangle(3, y + 3, 50, 19, COLOR_WHITE);
+    draw_rectangle(3, y + 3, 50, 19, COLOR_LWHITE);
+    draw_text(13, y + 10, "Start", COLOR_BLACK);
+    draw_filled_rectangle(56, y + 3, 1, 19, COLOR_BLACK);
+}
+
+static void draw_desktop_icon(int x, int y, unsigned char color, const char* label) {
+    draw_filled_rectangle(x, y, 32, 32, color);
+    draw_rectangle(x, y, 32, 32, COLOR_BLACK);
+    draw_text(x - 5, y + 40, label, COLOR_LWHITE);
+}
+
+static void render_desktop(surface_t* target) {
+    surface_t* previous = gui_set_target(target);
+    
+    gui_clear_framebuffer(COLOR_BLUE);
     draw_text(10, 10, "ScooterOS Desktop", COLOR_WHITE);
     draw_text(10, 25, "Press F or SPACE for CLI", COLOR_YELLOW);
+    display_memory_info(200, 20);
+    draw_desktop_icon(40, 80, COLOR_WHITE, "Computer");
+    draw_desktop_icon(120, 80, COLOR_YELLOW, "Folder");
+    draw_taskbar();
+    
+    gui_set_target(previous);
+}
+
+// Without a cache (allocation failed) everything is drawn directly
+void show_desktop(void) {
+    if (!desktop_cache.pixels) {
+        render_desktop(&gui_screen);
+        return;
+    }
+    if (!desktop_valid) {
+        render_desktop(&desktop_cache);
+        desktop_valid = 1;
+    }
+    surface_blit(&gui_screen, 0, 0, &desktop_cache, 0, 0, gui_screen.width, gui_screen.height);
+}
+
+// Put the cached desktop back under a rect (e.g. a closed window)
+void gui_restore_desktop(int x, int y, int width, int height) {
+    if (!desktop_cache.pixels || !desktop_valid) {
+        show_desktop();
+        return;
+    }
+    surface_blit(&gui_screen, x, y, &desktop_cache, x, y, width, height);
+}
+
+// Force the next show_desktop() to re-render the cache
+void gui_invalidate_desktop(void) {
+    desktop_valid = 0;
 }
 
 void display_memory_info(int x, int y) {
     draw_text(x, y, "Memory: 16MB", COLOR_WHITE);
 }
 
+// The string is clipped once; each glyph row is then written through a
+// row pointer, with the loop picked by depth outside the pixel loop
 void draw_text(int x, int y, const char* text, unsigned char color) {
+    surface_t* target = gui_target;
     int len = strlen(text);
-    for (int i = 0; i < len; i++) {
-        unsigned char ch = text[i];
-        // Simple character rendering - just a basic block for each character
-        for (int cy = 0; cy < 8; cy++) {
-            for (int cx = 0; cx < 8; cx++) {
-                // Simple pattern for demonstration
-                if ((ch >= 32 && ch <= 126) && (cx == 1 || cy == 1 || cx == 6 || cy == 6)) {
-                    asm_draw_pixel(x + i * 8 + cx, y + cy, color);
+    
+    int left = x < 0 ? 0 : x;
+    int right = x + len * GLYPH_SIZE;
+    if (right > target->width) right = target->width;
+    int top = y < 0 ? 0 : y;
+    int bottom = y + GLYPH_SIZE;
+    if (bottom > target->height) bottom = target->height;
+    if (left >= right || top >= bottom) return;
+    
+    // Characters with at least one visible column
+    int first = (left - x) / GLYPH_SIZE;
+    int last = (right - 1 - x) / GLYPH_SIZE;
+    uint32_t pixel = surface_color(target, color);
+    
+    for (int py = top; py < bottom; py++) {
+        uint8_t* row = target->pixels + py * target->pitch;
+        for (int i = first; i <= last; i++) {
+            uint8_t bits = glyph_row(text[i], py - y);
+            if (!bits) continue;
+            
+            int gx = x + i * GLYPH_SIZE;
+            int from = gx < left ? left - gx : 0;
+            int to = gx + GLYPH_SIZE > right ? right - gx : GLYPH_SIZE;
+            if (target->bpp == SURFACE_32BPP) {
+                uint32_t* out = (uint32_t*)row + gx;
+                for (int cx = from; cx < to; cx++) {
+                    if (bits & (0x80 >> cx)) out[cx] = pixel;
+                }
+            } else {
+                uint8_t* out = row + gx;
+                for (int cx = from; cx < to; cx++) {
+                    if (bits & (0x80 >> cx)) out[cx] = (uint8_t)pixel;
                 }
             }
         }
@@ -49,27 +195,34 @@ void draw_text(int x, int y, const char* text, unsigned char color) {
 }
 
 void draw_filled_rectangle(int x, int y, int width, int height, unsigned char color) {
-    for (int dy = 0; dy < height; dy++) {
-        for (int dx = 0; dx < width; dx++) {
-            asm_draw_pixel(x + dx, y + dy, color);
-        }
-    }
+    surface_fill_rect(gui_target, x, y, width, height, color);
 }
 
 void draw_rectangle(int x, int y, int width, int height, unsigned char color) {
     // Top and bottom lines
-    for (int dx = 0; dx < width; dx++) {
-        asm_draw_pixel(x + dx, y, color);
-        asm_draw_pixel(x + dx, y + height - 1, color);
-    }
+    surface_fill_rect(gui_target, x, y, width, 1, color);
+    surface_fill_rect(gui_target, x, y + height - 1, width, 1, color);
     // Left and right lines
-    for (int dy = 0; dy < height; dy++) {
-        asm_draw_pixel(x, y + dy, color);
-        asm_draw_pixel(x + width - 1, y + dy, color);
-    }
+    surface_fill_rect(gui_target, x, y, 1, height, color);
+    surface_fill_rect(gui_target, x + width - 1, y, 1, height, color);
 }
 
 void handle_keyboard_input(unsigned char key) {
     // Handle keyboard input - placeholder
     (void)key; // Suppress unused parameter warning
 }
+
+// Whole-screen operations go through memset/memcpy, which use the SSE2
+// kernels when fpu_init() found them
+void gui_clear_framebuffer(unsigned char color) {
+    surface_fill_rect(gui_target, 0, 0, gui_target->width, gui_target->height, color);
+}
+
+// Copy a SCREEN_WIDTH x SCREEN_HEIGHT 8bpp back buffer to the top-left of
+// the display (expanded on a 32bpp screen)
+void gui_present(const unsigned char* back_buffer) {
+    trace_event(TRACE_PRESENT_BEGIN, 0, 0);
+    surface_t frame = { (uint8_t*)back_buffer, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH, SURFACE_8BPP };
+    surface_blit(&gui_screen, 0, 0, &frame, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    trace_event(TRACE_PRESENT_END, 0, 0);
+}
@@ -1,6 +1,8 @@
 #ifndef GUI_H
 #define GUI_H
 
+#include "surface.h"
+
 // Assembly function prototypes
 extern void asm_clear_screen(unsigned char color);
 extern void asm_draw_pixel(int x, int y, unsigned char color);
@@ -26,18 +28,28 @@ extern void asm_delay(unsigned int count);
 #define COLOR_LWHITE    0x0F
 #define COLOR_DARK_GRAY 0x08
 
-// Screen dimensions
+// Mode 13h screen; a VBE mode's size is in gui_screen_surface()
 #define SCREEN_WIDTH    320
 #define SCREEN_HEIGHT   200
+#define VGA_FRAMEBUFFER ((unsigned char*)0xA0000)
 
 // GUI function prototypes
 void init_gui_system(void);
 void show_loading_screen(void);
+void show_loading_progress(int done, int total);
 void show_desktop(void);
+void gui_restore_desktop(int x, int y, int width, int height);
+void gui_invalidate_desktop(void);
 void display_memory_info(int x, int y);
 void draw_text(int x, int y, const char* text, unsigned char color);
 void draw_filled_rectangle(int x, int y, int width, int height, unsigned char color);
 void draw_rectangle(int x, int y, int width, int height, unsigned char color);
 void handle_keyboard_input(unsigned char key);
+void gui_clear_framebuffer(unsigned char color);
+void gui_present(const unsigned char* back_buffer);
+
+// Drawing target; NULL selects the screen again. Returns the previous one
+surface_t* gui_screen_surface(void);
+surface_t* gui_set_target(surface_t* target);
 
 #endif
@@ -0,0 +1,233 @@
+#include "interrupts.h"
+#include "cpu.h"
+#include "kprintf.h"
+#include "trace.h"
+#include "gdt.h"
+#include "paging.h"
+
+// 8259 PIC ports and commands
+#define PIC1_COMMAND    0x20
+#define PIC1_DATA       0x21
+#define PIC2_COMMAND    0xA0
+#define PIC2_DATA       0xA1
+#define PIC_EOI         0x20
+#define PIC_READ_ISR    0x0B
+#define ICW1_INIT       0x11    // Edge triggered, cascade, ICW4 follows
+#define ICW4_8086       0x01
+
+#define IDT_GATE_INT32  0x8E    // Present, ring 0, 32-bit interrupt gate
+#define IDT_GATE_USER   0xEE    // Same, but ring 3 may raise it with int
+#define IDT_GATE_TASK   0x85    // Present, ring 0, task gate
+
+#define EXCEPTION_DOUBLE_FAULT  8
+
+// Number of vectors with a stub in isr.asm
+#define ISR_STUB_COUNT  (IRQ_BASE + IRQ_COUNT)
+
+typedef struct {
+    uint16_t offset_low;
+    uint16_t selector;
+    uint8_t zero;
+    uint8_t type_attr;
+    uint16_t offset_high;
+} __attribute__((packed)) idt_entry_t;
+
+typedef struct {
+    uint16_t limit;
+    uint32_t base;
+} __attribute__((packed)) idt_descriptor_t;
+
+// Entry stubs (isr.asm)
+extern uint32_t isr_stub_table[ISR_STUB_COUNT];
+extern void isr_syscall(void);
+
+static idt_entry_t idt[IDT_ENTRIES] __attribute__((aligned(8)));
+static interrupt_handler_t handlers[IDT_ENTRIES];
+static interrupt_handler_t user_fault = 0;
+
+static const char* exception_names[EXCEPTION_COUNT] = {
+    "Divide error", "Debug", "NMI", "Breakpoint",
+    "Overflow", "Bound range", "Invalid opcode", "Device not available",
+    "Double fault", "Coprocessor overrun", "Invalid TSS", "Segment not present",
+    "Stack fault", "General protection", "Page fault", "Reserved",
+    "x87 error", "Alignment check", "Machine check", "SIMD error",
+    "Virtualization", "Control protection", "Reserved", "Reserved",
+    "Reserved", "Reserved", "Reserved", "Reserved",
+    "Reserved", "VMM communication", "Security", "Reserved"
+};
+
+static void idt_set_gate(uint8_t vector, uint32_t handler, uint8_t type_attr) {
+    idt[vector].offset_low = handler & 0xFFFF;
+    idt[vector].selector = KERNEL_CODE_SEG;
+    idt[vector].zero = 0;
+    idt[vector].type_attr = type_attr;
+    idt[vector].offset_high = handler >> 16;
+}
+
+// Runs as its own task on its own stack (see gdt_set_double_fault_task):
+// a page fault that cannot push its frame, such as a kernel stack running
+// into its guard page, ends up here rather than in a triple fault
+static void double_fault_task(void) {
+    uint32_t eip, esp;
+    
+    // The task switch set CR0.TS; memcpy may use SSE2
+    asm volatile("clts");
+    gdt_get_fault_context(&eip, &esp);
+    
+    vm_region_t* region = paging_enabled() ? paging_find_region((esp - 4) & PAGE_MASK) : 0;
+    if (region && (region->flags & VM_GUARD)) {
+        kprintf("\n*** Kernel stack overflow: guard page hit at 0x%08x (%s), eip 0x%08x ***\n",
+                (esp - 4) & PAGE_MASK, region->name, eip);
+    } else {
+        kprintf("\n*** Double fault at 0x%08x (esp 0x%08x) ***\n", eip, esp);
+    }
+    for (;;) {
+        asm volatile("hlt");
+    }
+}
+
+// Move the PIC lines off the CPU exception vectors and mask them all;
+// drivers unmask their line with irq_enable()
+static void pic_remap(void) {
+    cpu_outb(PIC1_COMMAND, ICW1_INIT);
+    cpu_io_wait();
+    cpu_outb(PIC2_COMMAND, ICW1_INIT);
+    cpu_io_wait();
+    cpu_outb(PIC1_DATA, IRQ_BASE);
+    cpu_io_wait();
+    cpu_outb(PIC2_DATA, IRQ_BASE + 8);
+    cpu_io_wait();
+    cpu_outb(PIC1_DATA, 1 << IRQ_CASCADE);  // Slave on IRQ2
+    cpu_io_wait();
+    cpu_outb(PIC2_DATA, 2);                 // Slave cascade identity
+    cpu_io_wait();
+    cpu_outb(PIC1_DATA, ICW4_8086);
+    cpu_io_wait();
+    cpu_outb(PIC2_DATA, ICW4_8086);
+    cpu_io_wait();
+    
+    cpu_outb(PIC1_DATA, 0xFF & ~(1 << IRQ_CASCADE));
+    cpu_outb(PIC2_DATA, 0xFF);
+}
+
+// Install the IDT with every stub in place. Interrupts stay disabled;
+// the caller enables them once its drivers are registered.
+void interrupts_init(void) {
+    for (int i = 0; i < IDT_ENTRIES; i++) {
+        handlers[i] = 0;
+        if (i < ISR_STUB_COUNT) {
+            idt_set_gate(i, isr_stub_table[i], IDT_GATE_INT32);
+        } else {
+            idt[i].type_attr = 0; // Not present
+        }
+    }
+    idt_set_gate(SYSCALL_VECTOR, (uint32_t)(uintptr_t)isr_syscall, IDT_GATE_USER);
+    
+    // A task gate ignores the offset; the selector names the TSS
+    gdt_set_double_fault_task(double_fault_task);
+    idt_set_gate(EXCEPTION_DOUBLE_FAULT, 0, IDT_GATE_TASK);
+    idt[EXCEPTION_DOUBLE_FAULT].selector = DOUBLE_FAULT_TSS_SEG;
+    
+    pic_remap();
+    
+    idt_descriptor_t descriptor;
+    descriptor.limit = sizeof(idt) - 1;
+    descriptor.base = (uint32_t)idt;
+    asm volatile("lidt %0" : : "m"(descriptor));
+}
+
+void interrupt_register(uint8_t vector, interrupt_handler_t handler) {
+    handlers[vector] = handler;
+}
+
+void irq_register(uint8_t irq, interrupt_handler_t handler) {
+    interrupt_register(IRQ_VECTOR(irq), handler);
+}
+
+void irq_enable(uint8_t irq) {
+    uint16_t port = irq < 8 ? PIC1_DATA : PIC2_DATA;
+    cpu_outb(port, cpu_inb(port) & ~(1 << (irq & 7)));
+}
+
+void irq_disable(uint8_t irq) {
+    uint16_t port = irq < 8 ? PIC1_DATA : PIC2_DATA;
+    cpu_outb(port, cpu_inb(port) | (1 << (irq & 7)));
+}
+
+// Mask every line but the cascade and return the old masks (slave in the
+// high byte) for irq_mask_restore(); IF is left as it is
+uint16_t irq_mask_all(void) {
+    uint16_t masks = cpu_inb(PIC1_DATA) | (cpu_inb(PIC2_DATA) << 8);
+    cpu_outb(PIC1_DATA, 0xFF & ~(1 << IRQ_CASCADE));
+    cpu_outb(PIC2_DATA, 0xFF);
+    return masks;
+}
+
+void irq_mask_restore(uint16_t masks) {
+    cpu_outb(PIC1_DATA, masks & 0xFF);
+    cpu_outb(PIC2_DATA, masks >> 8);
+}
+
+// IRQ 7 and 15 fire spuriously when a line drops before it is acknowledged;
+// only a bit in the in-service register marks a real interrupt
+static int pic_is_spurious(uint8_t irq) {
+    uint16_t port = irq < 8 ? PIC1_COMMAND : PIC2_COMMAND;
+    cpu_outb(port, PIC_READ_ISR);
+    return !(cpu_inb(port) & 0x80);
+}
+
+static void pic_send_eoi(uint8_t irq) {
+    if (irq >= 8) {
+        cpu_outb(PIC2_COMMAND, PIC_EOI);
+    }
+    cpu_outb(PIC1_COMMAND, PIC_EOI);
+}
+
+// Exceptions raised by ring 3 code go to handler (which ends the
+// program) instead of halting the machine
+void interrupt_set_user_fault(interrupt_handler_t handler) {
+    user_fault = handler;
+}
+
+// Unhandled CPU exceptions are fatal
+void interrupt_panic(interrupt_frame_t* frame) {
+    if ((frame->cs & 3) && user_fault) {
+        user_fault(frame);
+    }
+    kprintf("\n*** %s (vector %u, error 0x%x) at 0x%08x ***\n",
+            exception_names[frame->vector], frame->vector,
+            frame->error_code, frame->eip);
+    cpu_disable_interrupts();
+    for (;;) {
+        asm volatile("hlt");
+    }
+}
+
+// Called from isr_common for every vector
+void interrupt_dispatch(interrupt_frame_t* frame) {
+    uint32_t vector = frame->vector;
+    
+    if (vector >= IRQ_BASE && vector < IRQ_BASE + IRQ_COUNT) {
+        uint8_t irq = vector - IRQ_BASE;
+        if ((irq == 7 || irq == 15) && pic_is_spurious(irq)) {
+            if (irq == 15) {
+                pic_send_eoi(IRQ_CASCADE); // The master did see the cascade
+            }
+            return;
+        }
+        
+        trace_event(TRACE_IRQ_ENTER, irq, 0);
+        if (handlers[vector]) {
+            handlers[vector](frame);
+        }
+        pic_send_eoi(irq);
+        trace_event(TRACE_IRQ_EXIT, irq, 0);
+        return;
+    }
+    
+    if (handlers[vector]) {
+        handlers[vector](frame);
+    } else if (vector < EXCEPTION_COUNT) {
+        interrupt_panic(frame);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef INTERRUPTS_H
+#define INTERRUPTS_H
+
+#include <stdint.h>
+
+// Vector layout: CPU exceptions first, then the remapped 8259 PIC lines
+#define IDT_ENTRIES         256
+#define EXCEPTION_COUNT     32
+#define IRQ_BASE            0x20
+#define IRQ_COUNT           16
+#define IRQ_VECTOR(irq)     (IRQ_BASE + (irq))
+#define SYSCALL_VECTOR      0x80    // int 0x80, callable from ring 3
+
+// CPU exceptions with handlers outside interrupts.c
+#define EXCEPTION_PAGE_FAULT    14
+
+// Legacy IRQ lines
+#define IRQ_TIMER           0
+#define IRQ_KEYBOARD        1
+#define IRQ_CASCADE         2
+#define IRQ_COM2            3
+#define IRQ_COM1            4
+#define IRQ_MOUSE           12
+
+// Registers saved by isr_common (isr.asm), lowest address first
+typedef struct {
+    uint32_t es, ds;
+    uint32_t edi, esi, ebp, esp, ebx, edx, ecx, eax; // pusha
+    uint32_t vector;
+    uint32_t error_code;    // 0 when the CPU does not push one
+    uint32_t eip, cs, eflags;
+    uint32_t user_esp, user_ss; // Only pushed on entry from ring 3
+} interrupt_frame_t;
+
+typedef void (*interrupt_handler_t)(interrupt_frame_t* frame);
+
+// Interrupt functions
+void interrupts_init(void);
+void interrupt_register(uint8_t vector, interrupt_handler_t handler);
+void irq_register(uint8_t irq, interrupt_handler_t handler);
+void irq_enable(uint8_t irq);
+void irq_disable(uint8_t irq);
+uint16_t irq_mask_all(void);
+void irq_mask_restore(uint16_t masks);
+void interrupt_dispatch(interrupt_frame_t* frame);
+void interrupt_panic(interrupt_frame_t* frame);   // Report and halt
+void interrupt_set_user_fault(interrupt_handler_t handler);
+
+#endif // INTERRUPTS_H
@@ -0,0 +1,62 @@
+; isr.asm - Interrupt entry stubs
+[BITS 32]
+
+; One small stub per vector pushes a dummy error code where the CPU does
+; not push one, then the vector number, and joins isr_common. isr_common
+; saves the registers as an interrupt_frame_t (interrupts.h) and calls
+; interrupt_dispatch() in interrupts.c.
+
+extern interrupt_dispatch
+
+global isr_stub_table
+global isr_syscall
+
+KERNEL_DATA_SEG equ 0x10    ; Must match gdt.h
+SYSCALL_VECTOR equ 0x80     ; Must match interrupts.h
+
+; Exceptions that push an error code: 8, 10-14, 17, 21, 29, 30
+%assign i 0
+%rep 48
+isr_%+i:
+%if !(i == 8 || (i >= 10 && i <= 14) || i == 17 || i == 21 || i == 29 || i == 30)
+    push dword 0
+%endif
+    push dword i
+    jmp isr_common
+%assign i i + 1
+%endrep
+
+; int 0x80 (a ring 3 gate, see interrupts_init)
+isr_syscall:
+    push dword 0
+    push dword SYSCALL_VECTOR
+    jmp isr_common
+
+isr_common:
+    pusha
+    push ds
+    push es
+
+    mov ax, KERNEL_DATA_SEG
+    mov ds, ax
+    mov es, ax
+    cld
+
+    push esp                ; interrupt_frame_t*
+    call interrupt_dispatch
+    add esp, 4
+
+    pop es
+    pop ds
+    popa
+    add esp, 8              ; Vector and error code
+    iret
+
+; Stub addresses for the IDT, indexed by vector
+section .data
+isr_stub_table:
+%assign i 0
+%rep 48
+    dd isr_%+i
+%assign i i + 1
+%endrep
@@ -0,0 +1,328 @@
+#include "kprintf.h"
+#include "string.h"
+#include "serial.h"
+#include <stdint.h>
+
+// Console that kprintf writes to: the serial port until the CLI registers
+// itself in cli_init (the CLI tees its output to serial as well)
+static strbuf_flush_t console = serial_write;
+
+void strbuf_init(strbuf_t* sb, char* buf, size_t size) {
+    sb->buf = buf;
+    sb->size = size;
+    sb->len = 0;
+    sb->total = 0;
+    sb->flush = NULL;
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+}
+
+void strbuf_write(strbuf_t* sb, const char* text, size_t len) {
+    sb->total += len;
+    if (sb->size == 0) {
+        return;
+    }
+    
+    while (len > 0) {
+        size_t space = sb->size - 1 - sb->len;
+        if (space == 0) {
+            if (!sb->flush) {
+                break; // Truncate
+            }
+            // The flush sees a C string, and so does anyone reading buf
+            // after it returns
+            sb->buf[sb->len] = '\0';
+            sb->flush(sb->buf, sb->len);
+            sb->len = 0;
+            sb->buf[0] = '\0';
+            continue;
+        }
+        
+        size_t chunk = len < space ? len : space;
+        memcpy(sb->buf + sb->len, text, chunk);
+        sb->len += chunk;
+        text += chunk;
+        len -= chunk;
+    }
+    sb->buf[sb->len] = '\0';
+}
+
+void strbuf_putc(strbuf_t* sb, char c) {
+    strbuf_write(sb, &c, 1);
+}
+
+void strbuf_puts(strbuf_t* sb, const char* text) {
+    strbuf_write(sb, text, strlen(text));
+}
+
+// Write count copies of c
+static void strbuf_pad(strbuf_t* sb, char c, int count) {
+    char pad[16];
+    memset(pad, c, sizeof(pad));
+    while (count > 0) {
+        int chunk = count < (int)sizeof(pad) ? count : (int)sizeof(pad);
+        strbuf_write(sb, pad, chunk);
+        count -= chunk;
+    }
+}
+
+// 64-bit divide by 10 without libgcc (shift/add reciprocal, Hacker's Delight)
+static uint64_t udiv10(uint64_t n, unsigned* rem) {
+    uint64_t q = (n >> 1) + (n >> 2);
+    q += q >> 4;
+    q += q >> 8;
+    q += q >> 16;
+    q += q >> 32;
+    q >>= 3;
+    uint64_t r = n - q * 10;
+    if (r > 9) {
+        q++;
+        r -= 10;
+    }
+    *rem = (unsigned)r;
+    return q;
+}
+
+// Format an integer with sign, width, precision and padding in one pass
+static void format_number(strbuf_t* sb, uint64_t value, int negative, int base, int upper,
+                          int width, int precision, int left, int zero) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char temp[24];
+    int pos = 0;
+    
+    if (value == 0 && precision != 0) {
+        temp[pos++] = '0';
+    }
+    while (value > 0) {
+        if (base == 16) {
+            temp[pos++] = digits[value & 0x0F];
+            value >>= 4;
+        } else {
+            unsigned rem;
+            value = udiv10(value, &rem);
+            temp[pos++] = digits[rem];
+        }
+    }
+    
+    int zeros = precision > pos ? precision - pos : 0;
+    int body = pos + zeros + (negative ? 1 : 0);
+    int padding = width > body ? width - body : 0;
+    
+    // Zero padding applies only without an explicit precision
+    if (zero && !left && precision < 0) {
+        zeros += padding;
+        padding = 0;
+    }
+    
+    if (!left) {
+        strbuf_pad(sb, ' ', padding);
+    }
+    if (negative) {
+        strbuf_putc(sb, '-');
+    }
+    strbuf_pad(sb, '0', zeros);
+    
+    char out[24];
+    for (int i = 0; i < pos; i++) {
+        out[i] = temp[pos - 1 - i];
+    }
+    strbuf_write(sb, out, pos);
+    
+    if (left) {
+        strbuf_pad(sb, ' ', padding);
+    }
+}
+
+void strbuf_vprintf(strbuf_t* sb, const char* fmt, va_list args) {
+    while (*fmt) {
+        // Copy literal runs in one write
+        const char* start = fmt;
+        while (*fmt && *fmt != '%') {
+            fmt++;
+        }
+        if (fmt > start) {
+            strbuf_write(sb, start, fmt - start);
+        }
+        if (!*fmt) {
+            break;
+        }
+        fmt++; // Skip '%'
+        
+        // Flags
+        int left = 0;
+        int zero = 0;
+        for (;; fmt++) {
+            if (*fmt == '-') {
+                left = 1;
+            } else if (*fmt == '0') {
+                zero = 1;
+            } else {
+                break;
+            }
+        }
+        
+        // Width
+        int width = 0;
+        if (*fmt == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                left = 1;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') {
+                width = width * 10 + (*fmt++ - '0');
+            }
+        }
+        
+        // Precision
+        int precision = -1;
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            if (*fmt == '*') {
+                precision = va_arg(args, int);
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9') {
+                    precision = precision * 10 + (*fmt++ - '0');
+                }
+            }
+        }
+        
+        // Length
+        int longs = 0;
+        while (*fmt == 'l') {
+            longs++;
+            fmt++;
+        }
+        if (*fmt == 'z') {
+            fmt++;
+        }
+        
+        char conv = *fmt;
+        if (conv == '\0') {
+            break;
+        }
+        fmt++;
+        
+        switch (conv) {
+            case 'd':
+            case 'i': {
+                int64_t value = longs >= 2 ? va_arg(args, long long) :
+                                longs == 1 ? va_arg(args, long) : va_arg(args, int);
+                int negative = value < 0;
+                uint64_t magnitude = negative ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+                format_number(sb, magnitude, negative, 10, 0, width, precision, left, zero);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X': {
+                uint64_t value = longs >= 2 ? va_arg(args, unsigned long long) :
+                                 longs == 1 ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+                format_number(sb, value, 0, conv == 'u' ? 10 : 16, conv == 'X',
+                              width, precision, left, zero);
+                break;
+            }
+            case 'p': {
+                uintptr_t value = (uintptr_t)va_arg(args, void*);
+                strbuf_write(sb, "0x", 2);
+                format_number(sb, value, 0, 16, 0, sizeof(void*) * 2, -1, 0, 1);
+                break;
+            }
+            case 's': {
+                const char* text = va_arg(args, const char*);
+                if (!text) {
+                    text = "(null)";
+                }
+                int len = strlen(text);
+                if (precision >= 0 && precision < len) {
+                    len = precision;
+                }
+                int padding = width > len ? width - len : 0;
+                if (!left) {
+                    strbuf_pad(sb, ' ', padding);
+                }
+                strbuf_write(sb, text, len);
+                if (left) {
+                    strbuf_pad(sb, ' ', padding);
+                }
+                break;
+            }
+            case 'c': {
+                char c = (char)va_arg(args, int);
+                int padding = width > 1 ? width - 1 : 0;
+                if (!left) {
+                    strbuf_pad(sb, ' ', padding);
+                }
+                strbuf_putc(sb, c);
+                if (left) {
+                    strbuf_pad(sb, ' ', padding);
+                }
+                break;
+            }
+            case '%':
+                strbuf_putc(sb, '%');
+                break;
+            default:
+                // Unknown conversion: emit it verbatim
+                strbuf_putc(sb, '%');
+                strbuf_putc(sb, conv);
+                break;
+        }
+    }
+}
+
+void strbuf_printf(strbuf_t* sb, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    strbuf_vprintf(sb, fmt, args);
+    va_end(args);
+}
+
+int kvsnprintf(char* buf, size_t size, const char* fmt, va_list args) {
+    strbuf_t sb;
+    strbuf_init(&sb, buf, size);
+    strbuf_vprintf(&sb, fmt, args);
+    return sb.total;
+}
+
+int ksnprintf(char* buf, size_t size, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int total = kvsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return total;
+}
+
+void kprintf_set_console(strbuf_flush_t new_console) {
+    console = new_console;
+}
+
+static void console_flush(const char* text, size_t len) {
+    if (console) {
+        console(text, len);
+    }
+}
+
+// Format straight to the console through a small stack buffer that is
+// flushed whenever it fills up
+int kprintf(const char* fmt, ...) {
+    char buf[128];
+    strbuf_t sb;
+    strbuf_init(&sb, buf, sizeof(buf));
+    sb.flush = console_flush;
+    
+    va_list args;
+    va_start(args, fmt);
+    strbuf_vprintf(&sb, fmt, args);
+    va_end(args);
+    
+    if (sb.len > 0) {
+        console_flush(sb.buf, sb.len);
+    }
+    return sb.total;
+}
@@ -0,0 +1,38 @@
+#ifndef KPRINTF_H
+#define KPRINTF_H
+
+#include <stddef.h>
+#include <stdarg.h>
+
+// Called when a string builder with a flush function runs out of space;
+// text is NUL-terminated and len characters long
+typedef void (*strbuf_flush_t)(const char* text, size_t len);
+
+// Bounded string builder: never writes past size (always NUL-terminated).
+// Without a flush function extra output is dropped but still counted.
+typedef struct {
+    char* buf;
+    size_t size;
+    size_t len;             // Characters currently in buf
+    size_t total;           // Characters produced, including dropped ones
+    strbuf_flush_t flush;
+} strbuf_t;
+
+// String builder functions
+void strbuf_init(strbuf_t* sb, char* buf, size_t size);
+void strbuf_write(strbuf_t* sb, const char* text, size_t len);
+void strbuf_putc(strbuf_t* sb, char c);
+void strbuf_puts(strbuf_t* sb, const char* text);
+void strbuf_printf(strbuf_t* sb, const char* fmt, ...);
+void strbuf_vprintf(strbuf_t* sb, const char* fmt, va_list args);
+
+// Formatted output
+// Conversions: %d %i %u %x %X %p %s %c %%
+// Flags: '-' (left align), '0' (zero pad); width and precision may be '*'
+// Length: l, ll (64-bit), z
+int ksnprintf(char* buf, size_t size, const char* fmt, ...);
+int kvsnprintf(char* buf, size_t size, const char* fmt, va_list args);
+int kprintf(const char* fmt, ...);
+void kprintf_set_console(strbuf_flush_t console);
+
+#endif // KPRINTF_H
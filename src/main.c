@@ -2,88 +2,160 @@
 #include "memory.h"
 #include "fs.h"
 #include "cli.h"
+#include "bootlog.h"
+#include "fpu.h"
+#include "kprintf.h"
+#include "interrupts.h"
+#include "serial.h"
+#include "cpu.h"
+#include "trace.h"
+#include "pit.h"
+#include "compositor.h"
+#include "ps2mouse.h"
+#include "cursor.h"
+#include "frame.h"
+#include "paging.h"
+#include "gdt.h"
+#include "syscall.h"
+#include "task.h"
 
 // Assembly function declarations
 extern void asm_clear_screen(unsigned char color);
 extern void asm_draw_pixel(int x, int y, unsigned char color);
 extern unsigned char asm_get_keyboard(void);
-extern void asm_delay(unsigned int count);
 
 // External CLI state
 extern cli_state_t cli;
 
 // Override the GUI functions to use assembly implementations
 void clear_screen(unsigned char color) {
-    asm_clear_screen(color);
+    gui_clear_framebuffer(color);
 }
 
 void draw_pixel(int x, int y, unsigned char color) {
     asm_draw_pixel(x, y, color);
 }
 
+// Poll the keyboard like asm_get_keyboard, but leave mouse bytes (which
+// share the data port) to the IRQ 12 handler
+static unsigned char read_scancode(void) {
+    static unsigned char scancode = 0;
+    uint8_t status = cpu_inb(PS2_STATUS);
+    if ((status & PS2_STATUS_OUTPUT) && !(status & PS2_STATUS_AUX)) {
+        scancode = cpu_inb(PS2_DATA);
+    }
+    return scancode;
+}
+
+// Zero-filled data (linker.ld); the loader does not clear it
+extern char __bss_start[];
+extern char __bss_end[];
+
 // Main C function called from assembly
 void c_main(void) {
-    // Initialize subsystems
+    // Plain loop: memset() itself keeps its SSE2 hooks in .bss
+    for (char* p = __bss_start; p < __bss_end; p++) {
+        *p = 0;
+    }
+    bootlog_init();
+    trace_init();
+    
+    // Initialize subsystems (each stage is timed in the boot log)
+    int stage = bootlog_begin("fpu");
+    fpu_init();
+    bootlog_end(stage);
+    
+    // Serial console first so every later message reaches it
+    stage = bootlog_begin("serial");
+    gdt_init();
+    interrupts_init();
+    pit_init();
+    serial_init();
+    cpu_enable_interrupts();
+    bootlog_end(stage);
+    kprintf("scooterOS: serial console on COM1\n");
+    
+    // Paging before the heap: malloc() hands out demand-zero pages
+    stage = bootlog_begin("paging");
+    paging_init();
+    bootlog_end(stage);
+    
+    stage = bootlog_begin("memory");
     init_memory_manager();
+    bootlog_end(stage);
+    
+    // Ring 3 entry paths and the user stack
+    stage = bootlog_begin("syscall");
+    syscall_init();
+    bootlog_end(stage);
+    
+    // The boot context becomes task 0; it runs the main loop below
+    task_init();
+    
+    stage = bootlog_begin("gui");
     init_gui_system();
-    fs_init();
-    cli_init();
+    bootlog_end(stage);
     
-    // Show loading screen
+    // Show loading screen, then fill it as the remaining stages finish
     show_loading_screen();
+    show_loading_progress(2, 4);
     
-    // Show desktop
+    stage = bootlog_begin("fs");
+    fs_init();
+    bootlog_end(stage);
+    show_loading_progress(3, 4);
+    
+    stage = bootlog_begin("cli");
+    cli_init();
+    bootlog_end(stage);
+    show_loading_progress(4, 4);
+    
+    // Show desktop (rendered once into the desktop cache); windows are
+    // composed on top of it
     show_desktop();
+    compositor_init(gui_screen_surface(), gui_restore_desktop);
     
-    // Display memory information
-    display_memory_info(200, 20);
+    // Frame pacing: calibrate and pick vertical retrace or the PIT tick
+    stage = bootlog_begin("frame");
+    frame_init();
+    bootlog_end(stage);
+    bootlog_report();
+    
+    // Pointer, if a PS/2 mouse answers
+    surface_t* screen = gui_screen_surface();
+    if (mouse_init()) {
+        cursor_init(screen, screen->width / 2, screen->height / 2);
+    }
     
     // Main event loop
     unsigned char last_key = 0;
     
     while (1) {
-        unsigned char key = asm_get_keyboard();
+        // Let background tasks run between input polls
+        task_yield();
+        
+        unsigned char key = read_scancode();
         
         // Only process key press events (ignore release)
         if (key != last_key && !(key & 0x80)) {
-            // Debug: Show scan code on screen (remove later)
-            if (key != 0) {
+            // Debug: Show scan code on screen (remove later); the CLI
+            // window is composed, so never scribble over it
+            if (key != 0 && !cli.active) {
                 char debug_msg[32];
-                debug_msg[0] = 'K';
-                debug_msg[1] = 'e';
-                debug_msg[2] = 'y';
-                debug_msg[3] = ':';
-                debug_msg[4] = ' ';
-                debug_msg[5] = '0';
-                debug_msg[6] = 'x';
-                
-                // Convert scan code to hex
-                unsigned char high = (key >> 4) & 0x0F;
-                unsigned char low = key & 0x0F;
-                debug_msg[7] = (high < 10) ? ('0' + high) : ('A' + high - 10);
-                debug_msg[8] = (low < 10) ? ('0' + low) : ('A' + low - 10);
-                debug_msg[9] = '\0';
+                ksnprintf(debug_msg, sizeof(debug_msg), "Key: 0x%02X", key);
                 
+                int cursor = cursor_hide();
                 draw_text(200, 100, debug_msg, COLOR_YELLOW);
+                if (cursor) cursor_show();
             }
             
             // Try multiple possible scan codes for F key
+            // The CLI window covers the debug message, and leaving the CLI
+            // recomposes its area from the desktop cache
             if (key == 0x21 || key == 0x3D || key == 0x42) { // F key variations
                 cli_toggle();
-                if (cli.active) {
-                    // CLI mode activated - clear the debug message
-                    draw_filled_rectangle(200, 100, 100, 10, COLOR_CYAN);
-                } else {
-                    // Returned to desktop mode
-                    show_desktop();
-                    display_memory_info(200, 20);
-                }
             } else if (key == 0x39 && !cli.active) { // Spacebar as alternative CLI toggle
                 cli_toggle();
-                if (cli.active) {
-                    // CLI mode activated - clear the debug message
-                    draw_filled_rectangle(200, 100, 100, 10, COLOR_CYAN);
-                }
             } else if (cli.active) {
                 // Handle CLI input
                 cli_handle_keypress(key);
@@ -104,8 +176,9 @@ void c_main(void) {
                         
                     case 0x32: // M key - test memory
                         test_memory_system();
-                        show_desktop(); // Refresh display
-                        display_memory_info(200, 20);
+                        frame_begin();
+                        compositor_damage_screen(0, 0, screen->width, screen->height); // Refresh display
+                        frame_present();
                         break;
                 }
             }
@@ -113,12 +186,31 @@ void c_main(void) {
         
         last_key = key;
         
+        // Serial console input drives the CLI as well
+        int c;
+        while ((c = serial_getc()) >= 0) {
+            cli_handle_char(c);
+        }
+        
+        // Pointer motion only touches the pixels around the cursor
+        mouse_state_t mouse;
+        if (mouse_poll(&mouse)) {
+            int x, y;
+            cursor_get_position(&x, &y);
+            cursor_move(x + mouse.dx, y + mouse.dy);
+        }
+        
         // Update display based on mode
         if (cli.active) {
             cli_run();
         }
         
-        // Small delay to prevent excessive CPU usage
-        asm_delay(0x10000);
+        // Idle until the next interrupt; input is polled, so only while the
+        // PIT ticks to wake the loop up again
+        if (pit_is_running()) {
+            uint32_t flags = cpu_irq_save();
+            asm volatile("sti; hlt; cli" ::: "memory");
+            cpu_irq_restore(flags);
+        }
     }
 }
@@ -1,7 +1,16 @@
 #include "memory.h"
+#include "trace.h"
+#include "paging.h"
 
-// Simple memory pool for demonstration
-static char memory_pool[1024 * 1024]; // 1MB pool
+// The pool is a virtual reservation made by paging_init(): pages are
+// zero-filled on first touch, so only what malloc hands out is committed.
+// The host benchmark build has no paging and uses a static array
+#ifdef MEMORY_STATIC_POOL
+static char memory_pool[MEMORY_POOL_SIZE];
+#else
+#define MEMORY_POOL_SIZE PAGING_HEAP_SIZE
+static char* const memory_pool = (char*)PAGING_HEAP_BASE;
+#endif
 static int pool_offset = 0;
 static memory_stats_t stats = {0, 0, 0, 0};
 
@@ -14,7 +23,7 @@ void init_memory_manager(void) {
 }
 
 void* malloc(uint32_t size) {
-    if (pool_offset + size >= sizeof(memory_pool)) {
+    if (pool_offset + size >= MEMORY_POOL_SIZE) {
         return 0; // Out of memory
     }
     
@@ -27,6 +36,7 @@ void* malloc(uint32_t size) {
         stats.peak_usage = stats.total_allocated;
     }
     
+    trace_event(TRACE_MALLOC, size, (uint32_t)(uintptr_t)ptr);
     return ptr;
 }
 
@@ -34,6 +44,7 @@ void free(void* ptr) {
     // Simple implementation - just update stats
     (void)ptr; // Suppress unused parameter warning
     stats.free_count++;
+    trace_event(TRACE_FREE, (uint32_t)(uintptr_t)ptr, 0);
 }
 
 memory_stats_t get_memory_stats(void) {
@@ -0,0 +1,244 @@
+#include "paging.h"
+#include "interrupts.h"
+#include "bootlog.h"
+#include "kprintf.h"
+#include "string.h"
+#include "cpu.h"
+#include "gdt.h"
+
+// Page fault error code bits
+#define PF_PRESENT          0x01    // Protection violation, not a missing page
+#define PF_WRITE            0x02
+#define PF_USER             0x04
+
+#define ENTRIES_PER_TABLE   1024
+#define IDENTITY_TABLES     (PAGING_MEMORY_END / (PAGE_SIZE * ENTRIES_PER_TABLE))
+
+// End of the kernel image and its .bss, and the ring 3 code (linker.ld)
+extern char __kernel_end[];
+extern char __usertext_start[];
+extern char __usertext_end[];
+
+static uint32_t page_directory[ENTRIES_PER_TABLE] __attribute__((aligned(PAGE_SIZE)));
+static uint32_t identity_tables[IDENTITY_TABLES][ENTRIES_PER_TABLE] __attribute__((aligned(PAGE_SIZE)));
+static int enabled = 0;
+
+// Physical frames: never-used memory is handed out by a bump pointer,
+// released frames go on a list threaded through the frames themselves
+static uint32_t next_frame = 0;
+static uint32_t free_list = 0;
+
+static vm_region_t regions[PAGING_MAX_REGIONS];
+static uint32_t next_stack = PAGING_STACK_BASE;
+static paging_stats_t stats;
+
+uint32_t paging_alloc_frame(void) {
+    uint32_t frame = 0;
+    if (free_list) {
+        frame = free_list;
+        free_list = *(uint32_t*)frame;
+    } else if (next_frame < PAGING_MEMORY_END) {
+        frame = next_frame;
+        next_frame += PAGE_SIZE;
+    }
+    if (frame) stats.frames_free--;
+    return frame;
+}
+
+void paging_free_frame(uint32_t frame) {
+    *(uint32_t*)frame = free_list;
+    free_list = frame;
+    stats.frames_free++;
+}
+
+int paging_map(uint32_t virt, uint32_t phys, uint32_t flags) {
+    uint32_t* pde = &page_directory[virt >> 22];
+    if (!(*pde & PAGE_PRESENT)) {
+        uint32_t table = paging_alloc_frame();
+        if (!table) return -1;
+        memset((void*)table, 0, PAGE_SIZE);
+        *pde = table | PAGE_PRESENT | PAGE_WRITE;
+    }
+    // Directory entries only ever widen; the PTE has the final say
+    *pde |= flags & PAGE_USER;
+    
+    uint32_t* table = (uint32_t*)(*pde & PAGE_MASK);
+    table[(virt >> 12) & (ENTRIES_PER_TABLE - 1)] =
+        (phys & PAGE_MASK) | (flags & (PAGE_WRITE | PAGE_USER)) | PAGE_PRESENT;
+    if (enabled) cpu_invlpg(virt);
+    return 0;
+}
+
+// Remove a mapping; returns the frame it pointed to (0 if none)
+uint32_t paging_unmap(uint32_t virt) {
+    uint32_t pde = page_directory[virt >> 22];
+    if (!(pde & PAGE_PRESENT)) return 0;
+    
+    uint32_t* entry = &((uint32_t*)(pde & PAGE_MASK))[(virt >> 12) & (ENTRIES_PER_TABLE - 1)];
+    uint32_t old = *entry;
+    *entry = 0;
+    if (enabled) cpu_invlpg(virt);
+    return (old & PAGE_PRESENT) ? (old & PAGE_MASK) : 0;
+}
+
+// Physical address for virt, or 0 when it is not mapped
+uint32_t paging_translate(uint32_t virt) {
+    uint32_t pde = page_directory[virt >> 22];
+    if (!(pde & PAGE_PRESENT)) return 0;
+    uint32_t pte = ((uint32_t*)(pde & PAGE_MASK))[(virt >> 12) & (ENTRIES_PER_TABLE - 1)];
+    if (!(pte & PAGE_PRESENT)) return 0;
+    return (pte & PAGE_MASK) | (virt & ~PAGE_MASK);
+}
+
+vm_region_t* paging_find_region(uint32_t address) {
+    for (int i = 0; i < PAGING_MAX_REGIONS; i++) {
+        if (regions[i].end && address >= regions[i].start && address < regions[i].end) {
+            return &regions[i];
+        }
+    }
+    return 0;
+}
+
+// Reserve [start, start + size) without mapping anything; pages appear
+// when first touched. Returns 0 if the range overlaps another region
+vm_region_t* paging_reserve(uint32_t start, uint32_t size, uint32_t flags,
+                            const char* name, vm_fault_t fault, void* data) {
+    start &= PAGE_MASK;
+    uint32_t end = (start + size + PAGE_SIZE - 1) & PAGE_MASK;
+    vm_region_t* slot = 0;
+    
+    for (int i = 0; i < PAGING_MAX_REGIONS; i++) {
+        vm_region_t* r = &regions[i];
+        if (!r->end) {
+            if (!slot) slot = r;
+        } else if (start < r->end && end > r->start) {
+            return 0;
+        }
+    }
+    if (!slot) return 0;
+    
+    slot->start = start;
+    slot->end = end;
+    slot->flags = flags;
+    slot->name = name;
+    slot->fault = fault;
+    slot->data = data;
+    return slot;
+}
+
+// Unmap the region's pages, free their frames (unless VM_SHARED) and
+// drop the reservation
+void paging_release(vm_region_t* region) {
+    for (uint32_t page = region->start; page < region->end; page += PAGE_SIZE) {
+        uint32_t frame = paging_unmap(page);
+        if (frame) {
+            if (!(region->flags & VM_SHARED)) paging_free_frame(frame);
+            stats.pages_committed--;
+        }
+    }
+    region->end = 0;
+}
+
+// Stack of size bytes (rounded to pages) with an unmapped guard page
+// below it; returns the initial stack pointer, 0 when the area is full
+uint32_t paging_alloc_stack(uint32_t size) {
+    size = (size + PAGE_SIZE - 1) & PAGE_MASK;
+    if (next_stack + PAGE_SIZE + size > PAGING_STACK_BASE + PAGING_STACK_AREA) return 0;
+    
+    uint32_t guard = next_stack;
+    if (!paging_reserve(guard, PAGE_SIZE, VM_GUARD, "stack guard", 0, 0) ||
+        !paging_reserve(guard + PAGE_SIZE, size, PAGE_WRITE, "stack", 0, 0)) {
+        return 0;
+    }
+    next_stack += PAGE_SIZE + size;
+    return guard + PAGE_SIZE + size;
+}
+
+static int demand_zero(vm_region_t* region, uint32_t address) {
+    uint32_t frame = paging_alloc_frame();
+    if (!frame) return -1;
+    memset((void*)frame, 0, PAGE_SIZE);
+    if (paging_map(address, frame, region->flags) != 0) {
+        paging_free_frame(frame);
+        return -1;
+    }
+    return 0;
+}
+
+static void page_fault(interrupt_frame_t* frame) {
+    uint32_t address = cpu_read_cr2();
+    vm_region_t* region = paging_find_region(address);
+    stats.faults++;
+    
+    const char* reason;
+    if (!region) {
+        reason = "unmapped address";
+    } else if (region->flags & VM_GUARD) {
+        // Only reached when the faulting code was not on that stack; an
+        // overflowing kernel stack cannot take this frame and double faults
+        reason = "guard page hit (stack overflow)";
+    } else if (frame->error_code & PF_PRESENT) {
+        reason = "protection violation";
+    } else {
+        vm_fault_t fault = region->fault ? region->fault : demand_zero;
+        if (fault(region, address & PAGE_MASK) == 0) {
+            stats.pages_committed++;
+            return;
+        }
+        reason = "cannot map page";
+    }
+    
+    kprintf("\n*** Page fault: %s at 0x%08x (%s %s) ***\n", reason, address,
+            region ? region->name : "no region",
+            (frame->error_code & PF_WRITE) ? "write" : "read");
+    interrupt_panic(frame);
+}
+
+void paging_init(void) {
+    memset(&stats, 0, sizeof(stats));
+    next_frame = ((uint32_t)(uintptr_t)__kernel_end + PAGE_SIZE - 1) & PAGE_MASK;
+    stats.frames_total = (PAGING_MEMORY_END - next_frame) / PAGE_SIZE;
+    stats.frames_free = stats.frames_total;
+    
+    // Identity map physical memory for the kernel
+    for (int t = 0; t < IDENTITY_TABLES; t++) {
+        for (int i = 0; i < ENTRIES_PER_TABLE; i++) {
+            uint32_t phys = (uint32_t)(t * ENTRIES_PER_TABLE + i) * PAGE_SIZE;
+            identity_tables[t][i] = phys | PAGE_PRESENT | PAGE_WRITE;
+        }
+        page_directory[t] = (uint32_t)(uintptr_t)identity_tables[t] | PAGE_PRESENT | PAGE_WRITE;
+    }
+    
+    // A VBE linear framebuffer lives above physical memory
+    const volatile boot_info_t* info = boot_info();
+    if (info->magic == BOOT_INFO_MAGIC && info->fb_addr >= PAGING_MEMORY_END) {
+        uint32_t size = info->fb_pitch * info->fb_height;
+        for (uint32_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            paging_map(info->fb_addr + offset, info->fb_addr + offset, PAGE_WRITE);
+        }
+    }
+    
+    // Ring 3 may run (but not write) the kernel's .usertext pages
+    for (uint32_t page = (uint32_t)(uintptr_t)__usertext_start;
+         page < (uint32_t)(uintptr_t)__usertext_end; page += PAGE_SIZE) {
+        paging_map(page, page, PAGE_USER);
+    }
+    
+    paging_unmap(PAGING_BOOT_STACK_GUARD);
+    paging_reserve(PAGING_BOOT_STACK_GUARD, PAGE_SIZE, VM_GUARD, "boot stack guard", 0, 0);
+    paging_reserve(PAGING_HEAP_BASE, PAGING_HEAP_SIZE, PAGE_WRITE, "heap", 0, 0);
+    
+    interrupt_register(EXCEPTION_PAGE_FAULT, page_fault);
+    cpu_write_cr3((uint32_t)(uintptr_t)page_directory);
+    gdt_set_page_directory((uint32_t)(uintptr_t)page_directory);
+    cpu_write_cr0(cpu_read_cr0() | CR0_PG | CR0_WP);
+    enabled = 1;
+}
+
+int paging_enabled(void) {
+    return enabled;
+}
+
+paging_stats_t paging_get_stats(void) {
+    return stats;
+}
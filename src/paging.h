@@ -0,0 +1,86 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <stdint.h>
+
+// 32-bit paging with 4KB pages
+#define PAGE_SIZE           4096
+#define PAGE_PRESENT        0x001
+#define PAGE_WRITE          0x002
+#define PAGE_USER           0x004
+#define PAGE_MASK           0xFFFFF000
+
+// Physical memory; everything below it is identity mapped for the kernel
+#ifndef PAGING_MEMORY_END
+#define PAGING_MEMORY_END   (16 * 1024 * 1024)
+#endif
+
+// Virtual layout above the identity map
+#define PAGING_HEAP_BASE    0xD0000000  // malloc() pool, demand zero
+#define PAGING_HEAP_SIZE    (8 * 1024 * 1024)
+#define PAGING_STACK_BASE   0xE0000000  // Stacks from paging_alloc_stack()
+#define PAGING_STACK_AREA   (16 * 1024 * 1024)
+#define PAGING_CHANNEL_BASE 0xF0000000  // IPC rings, see channel.c
+#define PAGING_CHANNEL_AREA (16 * 1024 * 1024)
+
+// User space: programs from 16MB up, their stack (with a guard page
+// below) ending at PAGING_USER_STACK_TOP
+#define PAGING_USER_BASE        PAGING_MEMORY_END
+#define PAGING_USER_STACK_TOP   0xC0000000
+#define PAGING_USER_STACK_SIZE  (64 * 1024)
+
+// The boot stack grows down from 0x90000; its lowest page is left
+// unmapped so an overflow faults instead of corrupting memory below
+#define PAGING_BOOT_STACK_TOP   0x90000
+#define PAGING_BOOT_STACK_GUARD 0x80000
+
+#define PAGING_MAX_REGIONS  32
+
+// Region flags (the low bits are PAGE_* flags used for its mappings)
+#define VM_GUARD            0x100       // Never mapped, faults are fatal
+#define VM_SHARED           0x200       // Frames owned elsewhere, not freed on release
+
+typedef struct vm_region vm_region_t;
+
+// Resolve a not-present fault at address (page aligned) inside region;
+// returns 0 on success
+typedef int (*vm_fault_t)(vm_region_t* region, uint32_t address);
+
+// A reserved range of virtual addresses whose pages are mapped on first
+// touch by its fault handler (demand zero when none is given)
+struct vm_region {
+    uint32_t start;
+    uint32_t end;
+    uint32_t flags;
+    const char* name;
+    vm_fault_t fault;
+    void* data;
+};
+
+typedef struct {
+    uint32_t frames_total;      // Allocatable physical frames
+    uint32_t frames_free;
+    uint32_t pages_committed;   // Pages mapped by demand faults
+    uint32_t faults;
+} paging_stats_t;
+
+// Paging functions
+// paging_init() identity maps physical memory (and the framebuffer),
+// reserves the heap and the boot stack guard, installs the page fault
+// handler and turns paging on. Frames for demand faults and page tables
+// come from the memory above the kernel
+void paging_init(void);
+int paging_enabled(void);
+uint32_t paging_alloc_frame(void);
+void paging_free_frame(uint32_t frame);
+int paging_map(uint32_t virt, uint32_t phys, uint32_t flags);
+uint32_t paging_unmap(uint32_t virt);
+uint32_t paging_translate(uint32_t virt);
+vm_region_t* paging_reserve(uint32_t start, uint32_t size, uint32_t flags,
+                            const char* name, vm_fault_t fault, void* data);
+void paging_release(vm_region_t* region);
+vm_region_t* paging_find_region(uint32_t address);
+uint32_t paging_alloc_stack(uint32_t size);
+paging_stats_t paging_get_stats(void);
+
+#endif // PAGING_H
@@ -0,0 +1,80 @@
+#include "pipe.h"
+#include "channel.h"
+#include "string.h"
+
+// The node comes first so a pipe_t* is also its fs_node_t*
+typedef struct {
+    fs_node_vfs_t vfs;
+    channel_t* channel;
+    int open_ends;              // PIPE_READ_END | PIPE_WRITE_END
+} pipe_t;
+
+static pipe_t pipes[PIPE_MAX];
+static uint32_t next_pipe_inode = 0x80000000;  // Clear of ramdisk inodes
+
+// Offsets mean nothing for a pipe; data comes out in the order it went in
+static uint32_t pipe_read(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer) {
+    pipe_t* pipe = (pipe_t*)node;
+    uint32_t available;
+    uint8_t* data = channel_read_begin(pipe->channel, &available);
+    if (!data) return 0;
+    
+    if (available > size) available = size;
+    memcpy(buffer, data, available);
+    channel_read_end(pipe->channel, available);
+    return available;
+}
+
+// Writes in chunks of up to half the ring so the reader can drain one
+// half while the other fills; stops early if the read end is closed
+static uint32_t pipe_write(fs_node_t* node, uint32_t offset, uint32_t size, uint8_t* buffer) {
+    pipe_t* pipe = (pipe_t*)node;
+    uint32_t done = 0;
+    while (done < size) {
+        uint32_t chunk = size - done;
+        if (chunk > PIPE_SIZE / 2) chunk = PIPE_SIZE / 2;
+    
+        uint8_t* space = channel_write_begin(pipe->channel, chunk);
+        if (!space) break;
+        memcpy(space, buffer + done, chunk);
+        channel_write_end(pipe->channel, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+fs_node_t* pipe_create(void) {
+    pipe_t* pipe = 0;
+    for (int i = 0; i < PIPE_MAX && !pipe; i++) {
+        if (!pipes[i].open_ends) pipe = &pipes[i];
+    }
+    if (!pipe) return NULL;
+    
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->channel = channel_create(PIPE_SIZE);
+    if (!pipe->channel) return NULL;
+    
+    fs_node_t* node = &pipe->vfs.node;
+    node->name = fs_intern_name("pipe");
+    node->flags = FS_PIPE;
+    node->permissions = FS_PERM_READ | FS_PERM_WRITE;
+    node->inode = next_pipe_inode++;
+    pipe->vfs.read = pipe_read;
+    pipe->vfs.write = pipe_write;
+    pipe->open_ends = PIPE_READ_END | PIPE_WRITE_END;
+    return node;
+}
+
+// Closing either end ends the stream (EOF for the reader, failed writes
+// for the writer); the ring goes once both ends are closed
+void pipe_close(fs_node_t* node, int end) {
+    pipe_t* pipe = (pipe_t*)node;
+    if (!(pipe->open_ends & end)) return;
+    
+    channel_close(pipe->channel);
+    pipe->open_ends &= ~end;
+    if (!pipe->open_ends) {
+        channel_destroy(pipe->channel);
+        pipe->channel = 0;
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "fs.h"
+
+// Anonymous FS_PIPE nodes: fs_write() blocks while the ring is full,
+// fs_read() while it is empty, and returns 0 once the write end is
+// closed and the ring drained
+#define PIPE_MAX            8
+#define PIPE_SIZE           4096
+
+#define PIPE_READ_END       1
+#define PIPE_WRITE_END      2
+
+// Pipe functions
+fs_node_t* pipe_create(void);
+void pipe_close(fs_node_t* node, int end);
+
+#endif // PIPE_H
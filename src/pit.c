@@ -0,0 +1,69 @@
+#include "pit.h"
+#include "cpu.h"
+
+// PIT ports and mode
+#define PIT_CHANNEL0    0x40
+#define PIT_COMMAND     0x43
+#define PIT_MODE_RATE   0x34    // Channel 0, lobyte/hibyte, mode 2 (rate generator)
+
+static volatile uint32_t ticks = 0;
+static uint32_t rate_hz = 0;
+static int running = 0;
+static interrupt_handler_t tick_hook = 0;
+
+static void pit_irq(interrupt_frame_t* frame) {
+    ticks++;
+    if (tick_hook) {
+        tick_hook(frame);
+    }
+}
+
+void pit_init(void) {
+    ticks = 0;
+    rate_hz = 0;
+    running = 0;
+    tick_hook = 0;
+    irq_register(IRQ_TIMER, pit_irq);
+}
+
+// Program channel 0 for hz interrupts per second and unmask IRQ 0
+void pit_start(uint32_t hz, interrupt_handler_t hook) {
+    if (hz < PIT_MIN_HZ) {
+        hz = PIT_MIN_HZ;
+    } else if (hz > PIT_MAX_HZ) {
+        hz = PIT_MAX_HZ;
+    }
+    
+    uint32_t divisor = PIT_BASE_HZ / hz;
+    uint32_t flags = cpu_irq_save();
+    cpu_outb(PIT_COMMAND, PIT_MODE_RATE);
+    cpu_outb(PIT_CHANNEL0, divisor & 0xFF);
+    cpu_outb(PIT_CHANNEL0, divisor >> 8);
+    rate_hz = PIT_BASE_HZ / divisor;
+    tick_hook = hook;
+    running = 1;
+    irq_enable(IRQ_TIMER);
+    cpu_irq_restore(flags);
+}
+
+void pit_stop(void) {
+    irq_disable(IRQ_TIMER);
+    tick_hook = 0;
+    running = 0;
+}
+
+int pit_is_running(void) {
+    return running;
+}
+
+uint32_t pit_get_hz(void) {
+    return rate_hz;
+}
+
+interrupt_handler_t pit_get_hook(void) {
+    return tick_hook;
+}
+
+uint32_t pit_get_ticks(void) {
+    return ticks;
+}
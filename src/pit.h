@@ -0,0 +1,23 @@
+#ifndef PIT_H
+#define PIT_H
+
+#include <stdint.h>
+#include "interrupts.h"
+
+// 8253/8254 programmable interval timer, channel 0 on IRQ 0
+#define PIT_BASE_HZ     1193182
+#define PIT_MIN_HZ      19      // Divisor must fit in 16 bits
+#define PIT_MAX_HZ      10000
+
+// Timer functions
+// The timer line stays masked until pit_start(); each tick calls the hook
+// with the interrupted register state
+void pit_init(void);
+void pit_start(uint32_t hz, interrupt_handler_t hook);
+void pit_stop(void);
+int pit_is_running(void);
+uint32_t pit_get_hz(void);
+interrupt_handler_t pit_get_hook(void);
+uint32_t pit_get_ticks(void);
+
+#endif // PIT_H
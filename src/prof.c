@@ -0,0 +1,127 @@
+#include "prof.h"
+#include "pit.h"
+#include "string.h"
+
+// How far a sample may probe for a free slot before it is dropped
+#define PROF_MAX_PROBE  16
+
+// EIP histogram: open addressing on the exact sampled address
+static prof_entry_t table[PROF_SLOTS];
+static volatile uint32_t samples = 0;
+static volatile uint32_t dropped = 0;
+static int running = 0;
+
+// The timer as prof_start() found it; frame pacing, sys_sleep and the idle
+// halt rely on its ticks, so prof_stop() puts it back instead of stopping it
+static int saved_running = 0;
+static uint32_t saved_hz = 0;
+static interrupt_handler_t saved_hook = 0;
+
+static uint32_t prof_hash(uint32_t eip) {
+    return (eip * 2654435761u) >> 21; // Top 11 bits: PROF_SLOTS = 2048
+}
+
+// Timer tick hook, runs in IRQ context
+static void prof_sample(interrupt_frame_t* frame) {
+    uint32_t eip = frame->eip;
+    uint32_t slot = prof_hash(eip);
+    
+    for (int probe = 0; probe < PROF_MAX_PROBE; probe++) {
+        prof_entry_t* entry = &table[(slot + probe) & (PROF_SLOTS - 1)];
+        if (entry->count == 0) {
+            entry->eip = eip;
+        }
+        if (entry->eip == eip) {
+            entry->count++;
+            samples++;
+            return;
+        }
+    }
+    dropped++;
+}
+
+void prof_start(uint32_t hz) {
+    if (!running) {
+        saved_running = pit_is_running();
+        saved_hz = pit_get_hz();
+        saved_hook = pit_get_hook();
+    }
+    running = 1;
+    pit_start(hz ? hz : PROF_DEFAULT_HZ, prof_sample);
+}
+
+void prof_stop(void) {
+    if (!running) return;
+    if (saved_running) {
+        pit_start(saved_hz, saved_hook);
+    } else {
+        pit_stop();
+    }
+    running = 0;
+}
+
+void prof_reset(void) {
+    memset(table, 0, sizeof(table));
+    samples = 0;
+    dropped = 0;
+}
+
+int prof_is_running(void) {
+    return running;
+}
+
+uint32_t prof_samples(void) {
+    return samples;
+}
+
+uint32_t prof_dropped(void) {
+    return dropped;
+}
+
+// Copy the max most frequent EIPs into out, highest count first
+int prof_top(prof_entry_t* out, int max) {
+    int found = 0;
+    
+    for (int i = 0; i < PROF_SLOTS; i++) {
+        if (table[i].count == 0) {
+            continue;
+        }
+        
+        // Insertion into the sorted output
+        int pos = found < max ? found++ : max;
+        while (pos > 0 && out[pos - 1].count < table[i].count) {
+            if (pos < max) {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max) {
+            out[pos] = table[i];
+        }
+    }
+    return found;
+}
+
+// Write the histogram as text for scripts/symbolize_prof.py:
+//   PROF-BEGIN hz=<n> samples=<n> dropped=<n>
+//   P <eip hex> <count>
+//   PROF-END
+void prof_dump(strbuf_flush_t out) {
+    char buf[128];
+    strbuf_t sb;
+    strbuf_init(&sb, buf, sizeof(buf));
+    sb.flush = out;
+    
+    strbuf_printf(&sb, "PROF-BEGIN hz=%u samples=%u dropped=%u\n",
+                  pit_get_hz(), samples, dropped);
+    for (int i = 0; i < PROF_SLOTS; i++) {
+        if (table[i].count) {
+            strbuf_printf(&sb, "P %08x %u\n", table[i].eip, table[i].count);
+        }
+    }
+    strbuf_puts(&sb, "PROF-END\n");
+    
+    if (sb.len > 0) {
+        out(sb.buf, sb.len);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+#include "kprintf.h"
+
+// Sampling profiler limits
+#define PROF_SLOTS          2048    // Distinct EIPs, must be a power of two
+#define PROF_DEFAULT_HZ     1000
+
+// One histogram bucket
+typedef struct {
+    uint32_t eip;
+    uint32_t count;
+} prof_entry_t;
+
+// Profiler functions
+// Samples the interrupted EIP on every timer tick while running
+void prof_start(uint32_t hz);
+void prof_stop(void);
+void prof_reset(void);
+int prof_is_running(void);
+uint32_t prof_samples(void);
+uint32_t prof_dropped(void);
+int prof_top(prof_entry_t* out, int max);
+void prof_dump(strbuf_flush_t out);
+
+#endif // PROF_H
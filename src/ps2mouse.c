@@ -0,0 +1,137 @@
+#include "ps2mouse.h"
+#include "interrupts.h"
+#include "cpu.h"
+
+// Controller commands
+#define CTRL_READ_CONFIG    0x20
+#define CTRL_WRITE_CONFIG   0x60
+#define CTRL_ENABLE_AUX     0xA8
+#define CTRL_WRITE_AUX      0xD4
+
+#define CONFIG_AUX_IRQ      0x02    // Raise IRQ 12 for mouse bytes
+#define CONFIG_AUX_CLOCK    0x20    // Set = mouse clock disabled
+
+// Mouse commands
+#define MOUSE_SET_DEFAULTS  0xF6
+#define MOUSE_ENABLE_DATA   0xF4
+#define MOUSE_ACK           0xFA
+
+// Packet byte 0
+#define PACKET_ALWAYS_ONE   0x08
+#define PACKET_X_SIGN       0x10
+#define PACKET_Y_SIGN       0x20
+#define PACKET_OVERFLOW     0xC0
+
+#define PS2_TIMEOUT         100000
+
+static int present = 0;
+static uint8_t packet[3];
+static int packet_pos = 0;
+
+// Written by the IRQ handler, consumed by mouse_poll()
+static volatile int pending_dx = 0;
+static volatile int pending_dy = 0;
+static volatile uint8_t buttons = 0;
+static volatile int changed = 0;
+
+static int ps2_wait_write(void) {
+    for (int i = 0; i < PS2_TIMEOUT; i++) {
+        if (!(cpu_inb(PS2_STATUS) & PS2_STATUS_INPUT)) return 1;
+    }
+    return 0;
+}
+
+static int ps2_wait_read(void) {
+    for (int i = 0; i < PS2_TIMEOUT; i++) {
+        if (cpu_inb(PS2_STATUS) & PS2_STATUS_OUTPUT) return 1;
+    }
+    return 0;
+}
+
+static void ps2_command(uint8_t command) {
+    ps2_wait_write();
+    cpu_outb(PS2_COMMAND, command);
+}
+
+// Send a byte to the mouse and wait for its acknowledge
+static int mouse_command(uint8_t command) {
+    ps2_command(CTRL_WRITE_AUX);
+    ps2_wait_write();
+    cpu_outb(PS2_DATA, command);
+    return ps2_wait_read() && cpu_inb(PS2_DATA) == MOUSE_ACK;
+}
+
+static void mouse_packet(void) {
+    uint8_t flags = packet[0];
+    if (flags & PACKET_OVERFLOW) return;
+    
+    // 9-bit two's complement deltas; PS/2 y points up
+    int dx = packet[1] - ((flags & PACKET_X_SIGN) ? 256 : 0);
+    int dy = packet[2] - ((flags & PACKET_Y_SIGN) ? 256 : 0);
+    pending_dx += dx;
+    pending_dy -= dy;
+    buttons = flags & (MOUSE_BUTTON_LEFT | MOUSE_BUTTON_RIGHT | MOUSE_BUTTON_MIDDLE);
+    changed = 1;
+}
+
+static void mouse_irq(interrupt_frame_t* frame) {
+    (void)frame;
+    
+    uint8_t status;
+    while ((status = cpu_inb(PS2_STATUS)) & PS2_STATUS_OUTPUT) {
+        if (!(status & PS2_STATUS_AUX)) break; // Keyboard byte, leave it for the poller
+        
+        uint8_t byte = cpu_inb(PS2_DATA);
+        // Resynchronise on a byte that cannot start a packet
+        if (packet_pos == 0 && !(byte & PACKET_ALWAYS_ONE)) continue;
+        packet[packet_pos++] = byte;
+        if (packet_pos == 3) {
+            packet_pos = 0;
+            mouse_packet();
+        }
+    }
+}
+
+// Enable the auxiliary port and streaming mode. Returns 0 when no mouse
+// acknowledges, leaving IRQ 12 masked
+int mouse_init(void) {
+    present = 0;
+    packet_pos = 0;
+    
+    ps2_command(CTRL_ENABLE_AUX);
+    
+    ps2_command(CTRL_READ_CONFIG);
+    if (!ps2_wait_read()) return 0;
+    uint8_t config = cpu_inb(PS2_DATA);
+    config |= CONFIG_AUX_IRQ;
+    config &= ~CONFIG_AUX_CLOCK;
+    ps2_command(CTRL_WRITE_CONFIG);
+    ps2_wait_write();
+    cpu_outb(PS2_DATA, config);
+    
+    if (!mouse_command(MOUSE_SET_DEFAULTS) || !mouse_command(MOUSE_ENABLE_DATA)) {
+        return 0;
+    }
+    
+    present = 1;
+    irq_register(IRQ_MOUSE, mouse_irq);
+    irq_enable(IRQ_MOUSE);
+    return 1;
+}
+
+int mouse_present(void) {
+    return present;
+}
+
+int mouse_poll(mouse_state_t* state) {
+    uint32_t flags = cpu_irq_save();
+    int result = changed;
+    state->dx = pending_dx;
+    state->dy = pending_dy;
+    state->buttons = buttons;
+    pending_dx = 0;
+    pending_dy = 0;
+    changed = 0;
+    cpu_irq_restore(flags);
+    return result;
+}
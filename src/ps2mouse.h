@@ -0,0 +1,32 @@
+#ifndef PS2MOUSE_H
+#define PS2MOUSE_H
+
+#include <stdint.h>
+
+// PS/2 auxiliary device on the 8042 controller (IRQ 12)
+#define PS2_DATA        0x60
+#define PS2_STATUS      0x64
+#define PS2_COMMAND     0x64
+
+#define PS2_STATUS_OUTPUT   0x01    // Byte waiting in PS2_DATA
+#define PS2_STATUS_INPUT    0x02    // Controller busy, do not write yet
+#define PS2_STATUS_AUX      0x20    // Waiting byte came from the mouse
+
+#define MOUSE_BUTTON_LEFT   0x01
+#define MOUSE_BUTTON_RIGHT  0x02
+#define MOUSE_BUTTON_MIDDLE 0x04
+
+// Motion accumulated since the last mouse_poll(); dy grows downwards
+typedef struct {
+    int dx, dy;
+    uint8_t buttons;
+} mouse_state_t;
+
+// Mouse functions
+// The IRQ handler decodes 3-byte packets and sums the motion; the main
+// loop collects it with mouse_poll(), which returns 0 when nothing changed
+int mouse_init(void);
+int mouse_present(void);
+int mouse_poll(mouse_state_t* state);
+
+#endif // PS2MOUSE_H
@@ -0,0 +1,236 @@
+#include "serial.h"
+#include "interrupts.h"
+#include "kprintf.h"
+#include "cpu.h"
+#include <stdint.h>
+
+// UART registers (offsets from the base port)
+#define UART_DATA       0   // Receive/transmit buffer (DLAB=0)
+#define UART_IER        1   // Interrupt enable (DLAB=0)
+#define UART_DLL        0   // Divisor low byte (DLAB=1)
+#define UART_DLM        1   // Divisor high byte (DLAB=1)
+#define UART_IIR        2   // Interrupt identification (read)
+#define UART_FCR        2   // FIFO control (write)
+#define UART_LCR        3   // Line control
+#define UART_MCR        4   // Modem control
+#define UART_LSR        5   // Line status
+#define UART_MSR        6   // Modem status
+#define UART_SCRATCH    7
+
+#define IER_RDA         0x01    // Received data available
+#define IER_THRE        0x02    // Transmit holding register empty
+#define LCR_8N1         0x03
+#define LCR_DLAB        0x80
+#define FCR_ENABLE      0xC7    // Enable and clear FIFOs, 14-byte RX trigger
+#define MCR_DTR_RTS     0x03
+#define MCR_OUT2        0x08    // Gates the UART interrupt onto the bus
+#define MCR_LOOPBACK    0x10
+#define LSR_DATA_READY  0x01
+#define LSR_THRE        0x20
+#define IIR_NO_INT      0x01
+#define IIR_ID_MASK     0x0E
+#define IIR_ID_THRE     0x02
+#define IIR_ID_RDA      0x04
+#define IIR_ID_LINE     0x06
+#define IIR_ID_TIMEOUT  0x0C    // RX FIFO holds data below the trigger level
+
+#define UART_FIFO_SIZE  16
+#define UART_CLOCK      115200  // Divisor 1 = 115200 baud
+
+static uint16_t port = SERIAL_COM1;
+static int present = 0;
+
+// Transmit ring; head is written by serial_write, tail by the IRQ handler
+static char tx_ring[SERIAL_TX_SIZE];
+static volatile uint32_t tx_head = 0;
+static volatile uint32_t tx_tail = 0;
+
+// Receive ring; head is written by the IRQ handler, tail by serial_getc
+static char rx_ring[SERIAL_RX_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+
+static int tx_ready(void) {
+    return cpu_inb(port + UART_LSR) & LSR_THRE;
+}
+
+// Move up to one FIFO worth of queued bytes to the UART.
+// Called with interrupts disabled, only when the FIFO is empty.
+static void tx_fill_fifo(void) {
+    int count = 0;
+    while (tx_tail != tx_head && count < UART_FIFO_SIZE) {
+        cpu_outb(port + UART_DATA, tx_ring[tx_tail & (SERIAL_TX_SIZE - 1)]);
+        tx_tail++;
+        count++;
+    }
+    
+    // Only ask for an interrupt while there is more to send
+    cpu_outb(port + UART_IER, IER_RDA | (tx_tail != tx_head ? IER_THRE : 0));
+}
+
+// Poll until the ring is empty (interrupts disabled)
+static void tx_drain(void) {
+    while (tx_tail != tx_head) {
+        while (!tx_ready()) {
+        }
+        tx_fill_fifo();
+    }
+}
+
+// Empty the RX FIFO into the ring (bytes are dropped when it is full)
+static void rx_drain_fifo(void) {
+    while (cpu_inb(port + UART_LSR) & LSR_DATA_READY) {
+        char c = cpu_inb(port + UART_DATA);
+        if (rx_head - rx_tail < SERIAL_RX_SIZE) {
+            rx_ring[rx_head & (SERIAL_RX_SIZE - 1)] = c;
+            rx_head++;
+        }
+    }
+}
+
+static void serial_irq(interrupt_frame_t* frame) {
+    (void)frame;
+    
+    // Serve every pending cause; the IIR reports the highest priority one
+    for (;;) {
+        uint8_t iir = cpu_inb(port + UART_IIR);
+        if (iir & IIR_NO_INT) {
+            break;
+        }
+        
+        switch (iir & IIR_ID_MASK) {
+            case IIR_ID_RDA:
+            case IIR_ID_TIMEOUT:
+                rx_drain_fifo();
+                break;
+            case IIR_ID_THRE:
+                tx_fill_fifo();
+                break;
+            case IIR_ID_LINE:
+                cpu_inb(port + UART_LSR); // Reading the LSR clears it
+                break;
+            default:
+                cpu_inb(port + UART_MSR); // Modem status, read to clear
+                break;
+        }
+    }
+}
+
+// Program COM1 for 115200 8N1 with FIFOs. Returns 0 when no UART answers
+// (the loopback check fails), in which case all output is dropped.
+int serial_init(void) {
+    present = 0;
+    tx_head = tx_tail = 0;
+    rx_head = rx_tail = 0;
+    
+    cpu_outb(port + UART_IER, 0);
+    cpu_outb(port + UART_LCR, LCR_DLAB);
+    cpu_outb(port + UART_DLL, (UART_CLOCK / SERIAL_BAUD) & 0xFF);
+    cpu_outb(port + UART_DLM, (UART_CLOCK / SERIAL_BAUD) >> 8);
+    cpu_outb(port + UART_LCR, LCR_8N1);
+    cpu_outb(port + UART_FCR, FCR_ENABLE);
+    
+    // Loopback self test
+    cpu_outb(port + UART_MCR, MCR_LOOPBACK | MCR_DTR_RTS);
+    cpu_outb(port + UART_DATA, 0xAE);
+    if (cpu_inb(port + UART_DATA) != 0xAE) {
+        cpu_outb(port + UART_MCR, 0);
+        return 0;
+    }
+    
+    cpu_outb(port + UART_MCR, MCR_DTR_RTS | MCR_OUT2);
+    present = 1;
+    
+    irq_register(IRQ_COM1, serial_irq);
+    irq_enable(IRQ_COM1);
+    cpu_outb(port + UART_IER, IER_RDA);
+    return 1;
+}
+
+int serial_present(void) {
+    return present;
+}
+
+void serial_write(const char* text, size_t len) {
+    if (!present) {
+        return;
+    }
+    
+    while (len > 0) {
+        uint32_t flags = cpu_irq_save();
+        
+        // Queue as much as fits
+        while (len > 0 && tx_head - tx_tail < SERIAL_TX_SIZE) {
+            tx_ring[tx_head & (SERIAL_TX_SIZE - 1)] = *text++;
+            tx_head++;
+            len--;
+        }
+        
+        if (!(flags & EFLAGS_IF)) {
+            // No interrupts (early boot, handlers, panics): send it all now
+            tx_drain();
+        } else if (len > 0) {
+            // Ring full: make room by feeding the FIFO directly
+            while (!tx_ready()) {
+            }
+            tx_fill_fifo();
+        } else if (tx_ready()) {
+            // An idle transmitter raises no interrupt, so start it here
+            tx_fill_fifo();
+        }
+        
+        cpu_irq_restore(flags);
+    }
+}
+
+// Wait until everything queued has been handed to the UART
+void serial_flush(void) {
+    if (!present) {
+        return;
+    }
+    
+    uint32_t flags = cpu_irq_save();
+    tx_drain();
+    cpu_irq_restore(flags);
+}
+
+// Next received character, or -1 when none is waiting
+int serial_getc(void) {
+    if (!present) {
+        return -1;
+    }
+    
+    uint32_t flags = cpu_irq_save();
+    if (!(flags & EFLAGS_IF)) {
+        rx_drain_fifo(); // No interrupts to move the FIFO into the ring
+    }
+    
+    int c = -1;
+    if (rx_tail != rx_head) {
+        c = (unsigned char)rx_ring[rx_tail & (SERIAL_RX_SIZE - 1)];
+        rx_tail++;
+    }
+    cpu_irq_restore(flags);
+    return c;
+}
+
+static void serial_sink(const char* text, size_t len) {
+    serial_write(text, len);
+}
+
+void serial_kv(const char* event, const char* fmt, ...) {
+    char buf[128];
+    strbuf_t sb;
+    strbuf_init(&sb, buf, sizeof(buf));
+    sb.flush = serial_sink;
+    
+    strbuf_printf(&sb, "KV event=%s ", event);
+    
+    va_list args;
+    va_start(args, fmt);
+    strbuf_vprintf(&sb, fmt, args);
+    va_end(args);
+    
+    strbuf_putc(&sb, '\n');
+    serial_write(sb.buf, sb.len);
+}
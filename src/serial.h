@@ -0,0 +1,28 @@
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <stddef.h>
+
+// 16550 UART on COM1 (IRQ 4)
+#define SERIAL_COM1         0x3F8
+#define SERIAL_BAUD         115200
+#define SERIAL_TX_SIZE      4096    // Transmit ring, must be a power of two
+#define SERIAL_RX_SIZE      256     // Receive ring, must be a power of two
+
+// Serial console functions
+// serial_write() queues output and returns at once while interrupts are
+// enabled; a full ring (or interrupts being off) falls back to polling so
+// nothing is lost. Received bytes are queued by the same interrupt and
+// read with serial_getc()
+int serial_init(void);
+int serial_present(void);
+void serial_write(const char* text, size_t len);
+void serial_flush(void);
+int serial_getc(void);
+
+// Machine-readable record, one per line:
+//   KV event=<event> key=value key=value ...
+// fmt supplies the key=value pairs (values must not contain spaces)
+void serial_kv(const char* event, const char* fmt, ...);
+
+#endif // SERIAL_H
@@ -0,0 +1,104 @@
+; sse.asm - SSE2 bulk memory kernels
+[BITS 32]
+
+; Installed by fpu_init() (fpu.c) when CPUID reports SSE2 and the OS has
+; enabled CR4.OSFXSR. memcpy/memset in string.c hand sizes from 1KB up to
+; these, which covers framebuffer clears and back-buffer presents.
+
+global sse2_memcpy
+global sse2_memset
+
+; Copy memory 64 bytes at a time
+; void* sse2_memcpy(void* dest, const void* src, size_t num)
+sse2_memcpy:
+    push esi
+    push edi
+
+    mov edi, [esp + 12]     ; dest
+    mov esi, [esp + 16]     ; src
+    mov edx, [esp + 20]     ; num
+    mov eax, edi            ; Return dest
+
+    ; Byte copy up to a 16-byte aligned destination
+    mov ecx, edi
+    neg ecx
+    and ecx, 15
+    cmp ecx, edx
+    jbe .head
+    mov ecx, edx
+.head:
+    sub edx, ecx
+    rep movsb
+
+    ; Unaligned loads, aligned stores
+    mov ecx, edx
+    shr ecx, 6
+    jz .tail
+.block:
+    movdqu xmm0, [esi]
+    movdqu xmm1, [esi + 16]
+    movdqu xmm2, [esi + 32]
+    movdqu xmm3, [esi + 48]
+    movdqa [edi], xmm0
+    movdqa [edi + 16], xmm1
+    movdqa [edi + 32], xmm2
+    movdqa [edi + 48], xmm3
+    add esi, 64
+    add edi, 64
+    dec ecx
+    jnz .block
+
+.tail:
+    mov ecx, edx
+    and ecx, 63
+    rep movsb
+
+    pop edi
+    pop esi
+    ret
+
+; Fill memory 64 bytes at a time
+; void* sse2_memset(void* ptr, int value, size_t num)
+sse2_memset:
+    push edi
+
+    mov edi, [esp + 8]      ; ptr
+    movzx eax, byte [esp + 12]  ; value
+    mov edx, [esp + 16]     ; num
+
+    ; Broadcast the byte to all 16 lanes of XMM0 (AL keeps the byte)
+    imul eax, eax, 0x01010101
+    movd xmm0, eax
+    pshufd xmm0, xmm0, 0
+
+    ; Byte fill up to a 16-byte aligned destination
+    mov ecx, edi
+    neg ecx
+    and ecx, 15
+    cmp ecx, edx
+    jbe .head
+    mov ecx, edx
+.head:
+    sub edx, ecx
+    rep stosb
+
+    mov ecx, edx
+    shr ecx, 6
+    jz .tail
+.block:
+    movdqa [edi], xmm0
+    movdqa [edi + 16], xmm0
+    movdqa [edi + 32], xmm0
+    movdqa [edi + 48], xmm0
+    add edi, 64
+    dec ecx
+    jnz .block
+
+.tail:
+    mov ecx, edx
+    and ecx, 63
+    rep stosb
+
+    pop edi
+    mov eax, [esp + 4]      ; Return ptr
+    ret
@@ -0,0 +1,561 @@
+[BITS 16]
+[ORG 0x7E00]
+
+; 32-bit OS Bootloader (stage 2)
+; Loaded by boot.asm right after the boot sector. Reads the kernel image
+; header to learn its size and load address, loads the whole kernel with
+; INT 13h extended (LBA) reads in large chunks, then sets up protected
+; mode and jumps to the kernel entry point named in the header
+
+stage2_start:
+    ; Segments are still zero from stage 1
+    mov [boot_drive], dl
+
+    ; Boot profiling: stage 2 entry
+    mov di, BOOT_INFO + BINFO_TSC_STAGE2
+    call record_tsc
+
+    mov si, stage2_msg
+    call print_string_16
+
+    ; Pick LBA or CHS disk access
+    call detect_disk
+
+    ; Read and validate the kernel header
+    call read_kernel_header
+
+    ; Load the whole kernel image
+    call load_kernel
+
+    mov di, BOOT_INFO + BINFO_TSC_LOADED
+    call record_tsc
+
+    ; Pick the video mode while the BIOS is still reachable
+    call setup_video
+
+    ; Enable A20 line (required for protected mode)
+    call enable_a20
+
+    ; Boot profiling: last timestamp before the kernel takes over
+    mov dword [BOOT_INFO + BINFO_MAGIC], BOOT_INFO_MAGIC
+    mov di, BOOT_INFO + BINFO_TSC_KERNEL
+    call record_tsc
+
+    ; Set up GDT
+    lgdt [gdt_descriptor]
+
+    ; Switch to protected mode
+    mov eax, cr0
+    or eax, 1              ; Set PE bit
+    mov cr0, eax
+
+    ; Far jump to flush prefetch queue and load CS
+    jmp CODE_SEG:protected_mode
+
+; 16-bit functions
+print_string_16:
+    mov ah, 0x0E
+.loop:
+    lodsb
+    cmp al, 0
+    je .done
+    int 0x10
+    jmp .loop
+.done:
+    ret
+
+;   Video mode setup
+; With VBE defined (make VBE=1) look for a 32bpp linear framebuffer mode
+; no larger than VBE_WIDTH x VBE_HEIGHT, preferring the widest; otherwise,
+; or when the BIOS has none, use VGA mode 13h. The chosen geometry goes
+; into the boot information block for the kernel's drawing layer
+setup_video:
+%ifdef VBE
+    call vbe_find_mode
+    jc .vga
+
+    mov ax, 0x4F02
+    mov bx, [vbe_best_mode]
+    or bx, VBE_MODE_LFB
+    int 0x10
+    cmp ax, 0x004F
+    jne .vga
+
+    mov eax, [VBE_MODE_BUFFER + VMODE_PHYS_BASE]
+    mov [BOOT_INFO + BINFO_FB_ADDR], eax
+    movzx eax, word [VBE_MODE_BUFFER + VMODE_PITCH]
+    mov [BOOT_INFO + BINFO_FB_PITCH], eax
+    mov ax, [VBE_MODE_BUFFER + VMODE_WIDTH]
+    mov [BOOT_INFO + BINFO_FB_WIDTH], ax
+    mov ax, [VBE_MODE_BUFFER + VMODE_HEIGHT]
+    mov [BOOT_INFO + BINFO_FB_HEIGHT], ax
+    mov byte [BOOT_INFO + BINFO_FB_BPP], 32
+    ret
+.vga:
+%endif
+    mov ah, 0x00
+    mov al, 0x13        ; VGA mode 13h (320x200x256)
+    int 0x10
+
+    mov dword [BOOT_INFO + BINFO_FB_ADDR], 0xA0000
+    mov dword [BOOT_INFO + BINFO_FB_PITCH], 320
+    mov word [BOOT_INFO + BINFO_FB_WIDTH], 320
+    mov word [BOOT_INFO + BINFO_FB_HEIGHT], 200
+    mov byte [BOOT_INFO + BINFO_FB_BPP], 8
+    ret
+
+%ifdef VBE
+; Walk the VBE mode list. Returns CF clear with the best mode number in
+; vbe_best_mode and its mode info in VBE_MODE_BUFFER, CF set if none fits
+vbe_find_mode:
+    mov di, VBE_INFO_BUFFER
+    mov dword [di], 'VBE2'          ; Ask for the VBE 2.0+ info block
+    mov ax, 0x4F00
+    int 0x10
+    cmp ax, 0x004F
+    jne .fail
+    cmp dword [VBE_INFO_BUFFER], 'VESA'
+    jne .fail
+    cmp word [VBE_INFO_BUFFER + VINFO_VERSION], 0x0200
+    jb .fail                        ; Linear framebuffers need VBE 2.0
+
+    mov word [vbe_best_width], 0
+    mov si, [VBE_INFO_BUFFER + VINFO_MODES]
+    mov ax, [VBE_INFO_BUFFER + VINFO_MODES + 2]
+    mov fs, ax                      ; FS:SI = mode list
+
+.next_mode:
+    mov cx, [fs:si]
+    add si, 2
+    cmp cx, 0xFFFF                  ; End of list
+    je .done
+
+    push si
+    mov ax, 0x4F01
+    mov di, VBE_MODE_BUFFER
+    int 0x10
+    pop si
+    cmp ax, 0x004F
+    jne .next_mode
+
+    mov ax, [VBE_MODE_BUFFER + VMODE_ATTRIBUTES]
+    and ax, VBE_ATTR_WANTED
+    cmp ax, VBE_ATTR_WANTED
+    jne .next_mode
+    cmp byte [VBE_MODE_BUFFER + VMODE_BPP], 32
+    jne .next_mode
+    cmp byte [VBE_MODE_BUFFER + VMODE_MODEL], VBE_MODEL_DIRECT
+    jne .next_mode
+
+    mov ax, [VBE_MODE_BUFFER + VMODE_WIDTH]
+    cmp ax, VBE_WIDTH
+    ja .next_mode
+    cmp word [VBE_MODE_BUFFER + VMODE_HEIGHT], VBE_HEIGHT
+    ja .next_mode
+    cmp ax, [vbe_best_width]
+    jbe .next_mode
+    mov [vbe_best_width], ax
+    mov [vbe_best_mode], cx
+    jmp .next_mode
+
+.done:
+    cmp word [vbe_best_width], 0
+    je .fail
+
+    ; Reload the winner's mode info
+    mov cx, [vbe_best_mode]
+    mov ax, 0x4F01
+    mov di, VBE_MODE_BUFFER
+    int 0x10
+    cmp ax, 0x004F
+    jne .fail
+    clc
+    ret
+.fail:
+    stc
+    ret
+%endif
+
+; Store the time stamp counter at DS:DI
+record_tsc:
+    rdtsc
+    mov [di], eax
+    mov [di + 4], edx
+    ret
+
+enable_a20:
+    ; Method 1: Keyboard controller
+    call a20_wait
+    mov al, 0xAD
+    out 0x64, al
+
+    call a20_wait
+    mov al, 0xD0
+    out 0x64, al
+
+    call a20_wait2
+    in al, 0x60
+    push eax
+
+    call a20_wait
+    mov al, 0xD1
+    out 0x64, al
+
+    call a20_wait
+    pop eax
+    or al, 2
+    out 0x60, al
+
+    call a20_wait
+    mov al, 0xAE
+    out 0x64, al
+
+    call a20_wait
+    ret
+
+a20_wait:
+    in al, 0x64
+    test al, 2
+    jnz a20_wait
+    ret
+
+a20_wait2:
+    in al, 0x64
+    test al, 1
+    jz a20_wait2
+    ret
+
+; Check for INT 13h extensions; without them fall back to CHS reads
+; using the geometry reported by the BIOS
+detect_disk:
+    mov byte [use_lba], 0
+    mov ah, 0x41
+    mov bx, 0x55AA
+    mov dl, [boot_drive]
+    int 0x13
+    jc .chs
+    cmp bx, 0xAA55
+    jne .chs
+    test cx, 1              ; Bit 0: packet (DAP) access supported
+    jz .chs
+    mov byte [use_lba], 1
+    ret
+
+.chs:
+    push es
+    xor ax, ax
+    mov es, ax
+    xor di, di              ; ES:DI = 0:0 guards against BIOS bugs
+    mov ah, 0x08            ; Get drive parameters
+    mov dl, [boot_drive]
+    int 0x13
+    pop es
+    jc .done                ; Keep the floppy defaults
+
+    and cx, 0x3F            ; Sectors per track
+    jz .done
+    mov [sectors_per_track], cx
+    movzx dx, dh            ; Highest head number
+    inc dx
+    mov [heads], dx
+.done:
+    ret
+
+; Read [chunk_count] sectors starting at [next_lba] into [load_segment]:0
+; On return [chunk_count] holds the number of sectors actually read
+; (CHS reads stop at the end of a track), carry set on failure
+read_sectors:
+    cmp byte [use_lba], 0
+    je read_sectors_chs
+
+    mov byte [retries], 3
+.retry:
+    mov ax, [chunk_count]
+    mov [dap_count], ax
+    mov word [dap_offset], 0
+    mov ax, [load_segment]
+    mov [dap_segment], ax
+    mov eax, [next_lba]
+    mov [dap_lba], eax
+
+    mov si, dap
+    mov ah, 0x42            ; Extended read
+    mov dl, [boot_drive]
+    int 0x13
+    jnc .ok
+
+    xor ah, ah              ; Reset disk and try again
+    mov dl, [boot_drive]
+    int 0x13
+    dec byte [retries]
+    jnz .retry
+    stc
+    ret
+
+.ok:
+    ret
+
+read_sectors_chs:
+    ; LBA -> sector within track, clamp the count to the end of the track
+    mov eax, [next_lba]
+    xor edx, edx
+    movzx ebx, word [sectors_per_track]
+    div ebx                 ; EAX = track, EDX = sector within track
+    mov cx, bx
+    sub cx, dx
+    cmp cx, [chunk_count]
+    jae .clamped
+    mov [chunk_count], cx
+.clamped:
+    inc dl
+    mov [chs_sector], dl
+
+    ; Track -> cylinder and head
+    xor edx, edx
+    movzx ebx, word [heads]
+    div ebx                 ; EAX = cylinder, EDX = head
+    mov [chs_head], dl
+    mov [chs_cylinder], ax
+
+    mov byte [retries], 3
+.retry:
+    mov ax, [load_segment]
+    mov es, ax
+    xor bx, bx
+    mov ax, [chs_cylinder]
+    mov ch, al              ; Cylinder bits 0-7
+    mov cl, ah
+    shl cl, 6               ; Cylinder bits 8-9
+    or cl, [chs_sector]
+    mov dh, [chs_head]
+    mov dl, [boot_drive]
+    mov al, [chunk_count]
+    mov ah, 0x02            ; Read sectors function
+    int 0x13
+    jnc .ok
+
+    xor ah, ah              ; Reset disk and try again
+    mov dl, [boot_drive]
+    int 0x13
+    dec byte [retries]
+    jnz .retry
+
+    xor ax, ax
+    mov es, ax
+    stc
+    ret
+
+.ok:
+    xor ax, ax
+    mov es, ax
+    clc
+    ret
+
+; Read the first kernel sector into a scratch buffer and validate the header
+read_kernel_header:
+    mov dword [next_lba], KERNEL_LBA
+    mov word [chunk_count], 1
+    mov word [load_segment], HEADER_BUFFER >> 4
+    call read_sectors
+    jc disk_error
+
+    cmp dword [HEADER_BUFFER + KHDR_MAGIC], KERNEL_MAGIC
+    jne bad_kernel
+
+    ; Load address must be paragraph aligned and above stage 2
+    mov eax, [HEADER_BUFFER + KHDR_LOAD]
+    test al, 0x0F
+    jnz bad_kernel
+    cmp eax, STAGE2_OFFSET + STAGE2_SECTORS * 512
+    jb bad_kernel
+
+    ; The image must end below the stack
+    mov ecx, [HEADER_BUFFER + KHDR_SECTORS]
+    test ecx, ecx
+    jz bad_kernel
+    shl ecx, 9
+    add ecx, eax
+    cmp ecx, KERNEL_LOAD_LIMIT
+    ja bad_kernel
+
+    mov eax, [HEADER_BUFFER + KHDR_ENTRY]
+    mov [kernel_entry], eax
+    ret
+
+; Load the kernel image in CHUNK_SECTORS pieces
+load_kernel:
+    mov dword [next_lba], KERNEL_LBA
+    mov ax, [HEADER_BUFFER + KHDR_SECTORS]
+    mov [sectors_left], ax
+    mov eax, [HEADER_BUFFER + KHDR_LOAD]
+    shr eax, 4
+    mov [load_segment], ax
+
+.next_chunk:
+    mov cx, [sectors_left]
+    test cx, cx
+    jz .done
+    cmp cx, CHUNK_SECTORS
+    jbe .sized
+    mov cx, CHUNK_SECTORS
+.sized:
+    mov [chunk_count], cx
+    call read_sectors
+    jc disk_error
+
+    ; Advance by what was actually read
+    movzx ecx, word [chunk_count]
+    add [next_lba], ecx
+    sub [sectors_left], cx
+    shl cx, 5               ; Sectors to paragraphs (512 / 16)
+    add [load_segment], cx
+    jmp .next_chunk
+
+.done:
+    ret
+
+bad_kernel:
+    mov si, bad_kernel_msg
+    call print_string_16
+    cli
+    hlt
+
+disk_error:
+    mov si, error_msg
+    call print_string_16
+    cli
+    hlt
+
+; 32-bit protected mode code
+[BITS 32]
+protected_mode:
+    ; Set up segment registers for protected mode
+    mov ax, DATA_SEG
+    mov ds, ax
+    mov ss, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+
+    ; Set up stack
+    mov ebp, 0x90000
+    mov esp, ebp
+
+    ; Jump to the entry point named in the kernel header
+    jmp [kernel_entry]
+
+; Global Descriptor Table
+gdt_start:
+
+gdt_null:                  ; Null descriptor
+    dd 0x0
+    dd 0x0
+
+gdt_code:                  ; Code segment descriptor
+    dw 0xFFFF              ; Limit (bits 0-15)
+    dw 0x0000              ; Base (bits 0-15)
+    db 0x00                ; Base (bits 16-23)
+    db 10011010b           ; Access byte
+    db 11001111b           ; Granularity + limit (bits 16-19)
+    db 0x00                ; Base (bits 24-31)
+
+gdt_data:                  ; Data segment descriptor
+    dw 0xFFFF              ; Limit (bits 0-15)
+    dw 0x0000              ; Base (bits 0-15)
+    db 0x00                ; Base (bits 16-23)
+    db 10010010b           ; Access byte
+    db 11001111b           ; Granularity + limit (bits 16-19)
+    db 0x00                ; Base (bits 24-31)
+
+gdt_end:
+
+gdt_descriptor:
+    dw gdt_end - gdt_start - 1  ; Size
+    dd gdt_start                ; Offset
+
+; Disk address packet for INT 13h AH=42h
+dap:
+    db 0x10                ; Packet size
+    db 0                   ; Reserved
+dap_count   dw 0           ; Sectors to read
+dap_offset  dw 0           ; Buffer offset
+dap_segment dw 0           ; Buffer segment
+dap_lba     dd 0, 0        ; Starting LBA (64-bit)
+
+; Constants
+CODE_SEG equ gdt_code - gdt_start
+DATA_SEG equ gdt_data - gdt_start
+STAGE2_OFFSET equ 0x7E00   ; Must match boot.asm
+STAGE2_SECTORS equ 4       ; Must match boot.asm
+KERNEL_LBA equ 1 + STAGE2_SECTORS
+CHUNK_SECTORS equ 64       ; 32KB per read
+HEADER_BUFFER equ 0x0600   ; Scratch sector in free low memory
+KERNEL_LOAD_LIMIT equ 0x80000  ; Keep 64KB below the 0x90000 stack
+
+; Kernel image header (first bytes of the kernel, see linker.ld)
+KERNEL_MAGIC equ 0x534F4353    ; 'SCOS'
+KHDR_MAGIC equ 0
+KHDR_SECTORS equ 4         ; Image size in 512-byte sectors
+KHDR_ENTRY equ 8           ; Entry point
+KHDR_LOAD equ 12           ; Load address
+
+; Boot information block handed to the kernel (see bootlog.h)
+BOOT_INFO equ 0x0500
+BOOT_INFO_MAGIC equ 0x544F4F42 ; 'BOOT'
+BINFO_MAGIC equ 0
+BINFO_TSC_STAGE1 equ 8     ; Written by boot.asm
+BINFO_TSC_STAGE2 equ 16
+BINFO_TSC_LOADED equ 24
+BINFO_TSC_KERNEL equ 32
+BINFO_FB_ADDR equ 40
+BINFO_FB_PITCH equ 44
+BINFO_FB_WIDTH equ 48
+BINFO_FB_HEIGHT equ 50
+BINFO_FB_BPP equ 52
+
+; VBE mode selection (make VBE=1, target size overridable with -D)
+%ifndef VBE_WIDTH
+VBE_WIDTH equ 1024
+%endif
+%ifndef VBE_HEIGHT
+VBE_HEIGHT equ 768
+%endif
+VBE_INFO_BUFFER equ 0x1000     ; 512-byte VbeInfoBlock in free low memory
+VBE_MODE_BUFFER equ 0x1200     ; 256-byte ModeInfoBlock
+VINFO_VERSION equ 4
+VINFO_MODES equ 14             ; Far pointer to the mode list
+VMODE_ATTRIBUTES equ 0
+VMODE_PITCH equ 16
+VMODE_WIDTH equ 18
+VMODE_HEIGHT equ 20
+VMODE_BPP equ 25
+VMODE_MODEL equ 27
+VMODE_PHYS_BASE equ 40
+VBE_ATTR_WANTED equ 0x0091     ; Supported, graphics, linear framebuffer
+VBE_MODEL_DIRECT equ 6
+VBE_MODE_LFB equ 0x4000
+
+; Variables
+boot_drive db 0
+use_lba db 0
+retries db 0
+sectors_per_track dw 18    ; Floppy defaults for the CHS fallback
+heads dw 2
+chs_cylinder dw 0
+chs_head db 0
+chs_sector db 0
+next_lba dd 0
+chunk_count dw 0
+sectors_left dw 0
+load_segment dw 0
+kernel_entry dd 0
+vbe_best_mode dw 0
+vbe_best_width dw 0
+
+; Messages
+stage2_msg db 'Stage 2: loading kernel...', 13, 10, 0
+bad_kernel_msg db 'Invalid kernel image!', 13, 10, 0
+error_msg db 'Disk read error!', 13, 10, 0
+
+; Pad stage 2 to a whole number of sectors
+times STAGE2_SECTORS*512-($-$$) db 0
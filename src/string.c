@@ -1,11 +1,56 @@
 #include "string.h"
+#include <stdint.h>
+
+// Word types for the word-at-a-time loops. may_alias keeps the compiler
+// from assuming char buffers are never accessed as words; the unaligned
+// variant is only used for sources, which x86 loads at any alignment.
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) uword_t;
+
+#define WORD_SIZE     sizeof(word_t)
+#define WORD_MASK     (WORD_SIZE - 1)
+#define ONES          0x01010101u
+#define HIGHS         0x80808080u
+
+// Non-zero if any byte of the word is zero
+#define HAS_ZERO(w)   (((w) - ONES) & ~(w) & HIGHS)
+
+// Sizes from which memcpy/memset switch to rep movsd/stosd
+#define REP_THRESHOLD 256
+
+// Sizes from which memcpy/memset hand over to the bulk kernels
+#define BULK_THRESHOLD 1024
+
+// Bulk kernels installed at boot when the CPU supports them (see fpu.c)
+static memcpy_func_t bulk_memcpy = NULL;
+static memset_func_t bulk_memset = NULL;
+
+void string_set_bulk_ops(memcpy_func_t copy, memset_func_t set) {
+    bulk_memcpy = copy;
+    bulk_memset = set;
+}
 
 int strlen(const char* str) {
-    int len = 0;
-    while (str[len] != '\0') {
-        len++;
+    const char* p = str;
+    
+    // Byte steps up to a word boundary; aligned word reads never cross a page
+    while ((uintptr_t)p & WORD_MASK) {
+        if (*p == '\0') {
+            return p - str;
+        }
+        p++;
+    }
+    
+    const word_t* w = (const word_t*)p;
+    while (!HAS_ZERO(*w)) {
+        w++;
     }
-    return len;
+    
+    p = (const char*)w;
+    while (*p) {
+        p++;
+    }
+    return p - str;
 }
 
 int strcmp(const char* str1, const char* str2) {
@@ -55,19 +100,86 @@ char* strcat(char* dest, const char* src) {
 }
 
 char* strchr(const char* str, int c) {
+    char ch = (char)c;
+    
+    while ((uintptr_t)str & WORD_MASK) {
+        if (*str == ch) {
+            return (char*)str;
+        }
+        if (*str == '\0') {
+            return NULL;
+        }
+        str++;
+    }
+    
+    // Skip words holding neither the terminator nor the character
+    word_t pattern = (unsigned char)ch * ONES;
+    const word_t* w = (const word_t*)str;
+    while (!HAS_ZERO(*w) && !HAS_ZERO(*w ^ pattern)) {
+        w++;
+    }
+    
+    str = (const char*)w;
     while (*str) {
-        if (*str == c) {
+        if (*str == ch) {
             return (char*)str;
         }
         str++;
     }
-    return (*str == c) ? (char*)str : NULL;
+    return (ch == '\0') ? (char*)str : NULL;
+}
+
+// First occurrence of needle in haystack; strchr finds the candidates
+char* strstr(const char* haystack, const char* needle) {
+    if (*needle == '\0') {
+        return (char*)haystack;
+    }
+    
+    int rest = strlen(needle + 1);
+    while ((haystack = strchr(haystack, *needle)) != NULL) {
+        if (strncmp(haystack + 1, needle + 1, rest) == 0) {
+            return (char*)haystack;
+        }
+        haystack++;
+    }
+    return NULL;
 }
 
 void* memset(void* ptr, int value, size_t num) {
     unsigned char* p = (unsigned char*)ptr;
+    unsigned char byte = (unsigned char)value;
+    
+    if (bulk_memset && num >= BULK_THRESHOLD) {
+        return bulk_memset(ptr, value, num);
+    }
+    
+    if (num >= WORD_SIZE * 2) {
+        word_t pattern = byte * ONES;
+        
+        while ((uintptr_t)p & WORD_MASK) {
+            *p++ = byte;
+            num--;
+        }
+        
+        size_t words = num / WORD_SIZE;
+        num &= WORD_MASK;
+        
+        if (words * WORD_SIZE >= REP_THRESHOLD) {
+            asm volatile("rep stosl"
+                         : "+D"(p), "+c"(words)
+                         : "a"(pattern)
+                         : "memory");
+        } else {
+            word_t* w = (word_t*)p;
+            while (words--) {
+                *w++ = pattern;
+            }
+            p = (unsigned char*)w;
+        }
+    }
+    
     while (num--) {
-        *p++ = (unsigned char)value;
+        *p++ = byte;
     }
     return ptr;
 }
@@ -75,6 +187,37 @@ void* memset(void* ptr, int value, size_t num) {
 void* memcpy(void* dest, const void* src, size_t num) {
     unsigned char* d = (unsigned char*)dest;
     const unsigned char* s = (const unsigned char*)src;
+    
+    if (bulk_memcpy && num >= BULK_THRESHOLD) {
+        return bulk_memcpy(dest, src, num);
+    }
+    
+    if (num >= WORD_SIZE * 2) {
+        // Align the destination; sources are loaded unaligned if need be
+        while ((uintptr_t)d & WORD_MASK) {
+            *d++ = *s++;
+            num--;
+        }
+        
+        size_t words = num / WORD_SIZE;
+        num &= WORD_MASK;
+        
+        if (words * WORD_SIZE >= REP_THRESHOLD) {
+            asm volatile("rep movsl"
+                         : "+D"(d), "+S"(s), "+c"(words)
+                         :
+                         : "memory");
+        } else {
+            word_t* wd = (word_t*)d;
+            const uword_t* ws = (const uword_t*)s;
+            while (words--) {
+                *wd++ = *ws++;
+            }
+            d = (unsigned char*)wd;
+            s = (const unsigned char*)ws;
+        }
+    }
+    
     while (num--) {
         *d++ = *s++;
     }
@@ -84,6 +227,14 @@ void* memcpy(void* dest, const void* src, size_t num) {
 int memcmp(const void* ptr1, const void* ptr2, size_t num) {
     const unsigned char* p1 = (const unsigned char*)ptr1;
     const unsigned char* p2 = (const unsigned char*)ptr2;
+    
+    // Skip equal words, then let the byte loop find the first difference
+    while (num >= WORD_SIZE && *(const uword_t*)p1 == *(const uword_t*)p2) {
+        p1 += WORD_SIZE;
+        p2 += WORD_SIZE;
+        num -= WORD_SIZE;
+    }
+    
     while (num--) {
         if (*p1 != *p2) {
             return *p1 - *p2;
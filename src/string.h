@@ -11,10 +11,16 @@ char* strcpy(char* dest, const char* src);
 char* strncpy(char* dest, const char* src, size_t n);
 char* strcat(char* dest, const char* src);
 char* strchr(const char* str, int c);
+char* strstr(const char* haystack, const char* needle);
 void* memset(void* ptr, int value, size_t num);
 void* memcpy(void* dest, const void* src, size_t num);
 int memcmp(const void* ptr1, const void* ptr2, size_t num);
 
+// Bulk memcpy/memset kernels for large sizes (e.g. SSE2, see fpu.c)
+typedef void* (*memcpy_func_t)(void* dest, const void* src, size_t num);
+typedef void* (*memset_func_t)(void* ptr, int value, size_t num);
+void string_set_bulk_ops(memcpy_func_t copy, memset_func_t set);
+
 // Additional utility functions
 void str_to_upper(char* str);
 void str_to_lower(char* str);
@@ -0,0 +1,122 @@
+#include "surface.h"
+#include "string.h"
+
+// Default VGA palette, first 16 entries (indices above wrap)
+static const uint32_t vga_palette[16] = {
+    0x000000, 0x0000AA, 0x00AA00, 0x00AAAA, 0xAA0000, 0xAA00AA, 0xAA5500, 0xAAAAAA,
+    0x555555, 0x5555FF, 0x55FF55, 0x55FFFF, 0xFF5555, 0xFF55FF, 0xFFFF55, 0xFFFFFF,
+};
+
+void surface_init(surface_t* surface, uint8_t* pixels, int width, int height, int pitch, int bpp) {
+    surface->pixels = pixels;
+    surface->width = width;
+    surface->height = height;
+    surface->pitch = pitch;
+    surface->bpp = bpp;
+}
+
+// Pixel value for a palette index on this surface
+uint32_t surface_color(const surface_t* surface, uint8_t color) {
+    return surface->bpp == SURFACE_32BPP ? vga_palette[color & 15] : color;
+}
+
+void surface_put_pixel(surface_t* surface, int x, int y, uint8_t color) {
+    if (x < 0 || y < 0 || x >= surface->width || y >= surface->height) return;
+    uint8_t* row = surface->pixels + y * surface->pitch;
+    if (surface->bpp == SURFACE_32BPP) {
+        ((uint32_t*)row)[x] = vga_palette[color & 15];
+    } else {
+        row[x] = color;
+    }
+}
+
+// Clip a rect to a width x height area; returns 0 when nothing is left
+static int clip_rect(int* x, int* y, int* width, int* height, int max_width, int max_height) {
+    if (*x < 0) { *width += *x; *x = 0; }
+    if (*y < 0) { *height += *y; *y = 0; }
+    if (*x + *width > max_width) *width = max_width - *x;
+    if (*y + *height > max_height) *height = max_height - *y;
+    return *width > 0 && *height > 0;
+}
+
+static void fill32(uint32_t* out, uint32_t value, int count) {
+    while (count--) {
+        *out++ = value;
+    }
+}
+
+// 8bpp palette indices to 32bpp pixels
+static void expand8to32(uint32_t* out, const uint8_t* in, int count) {
+    while (count--) {
+        *out++ = vga_palette[*in++ & 15];
+    }
+}
+
+void surface_fill_rect(surface_t* surface, int x, int y, int width, int height, uint8_t color) {
+    if (!clip_rect(&x, &y, &width, &height, surface->width, surface->height)) return;
+    
+    if (surface->bpp == SURFACE_32BPP) {
+        uint8_t* row = surface->pixels + y * surface->pitch + x * 4;
+        uint32_t value = vga_palette[color & 15];
+        for (int dy = 0; dy < height; dy++) {
+            fill32((uint32_t*)row, value, width);
+            row += surface->pitch;
+        }
+        return;
+    }
+    
+    uint8_t* row = surface->pixels + y * surface->pitch + x;
+    if (width == surface->pitch) {
+        // Full-pitch spans are one contiguous block
+        memset(row, color, width * height);
+        return;
+    }
+    for (int dy = 0; dy < height; dy++) {
+        memset(row, color, width);
+        row += surface->pitch;
+    }
+}
+
+void surface_blit(surface_t* dst, int dst_x, int dst_y,
+                  const surface_t* src, int src_x, int src_y, int width, int height) {
+    int expand = src->bpp == SURFACE_8BPP && dst->bpp == SURFACE_32BPP;
+    if (src->bpp != dst->bpp && !expand) return;
+    
+    // Clip against the source, then carry the offsets over to the destination
+    int x = src_x, y = src_y;
+    if (!clip_rect(&x, &y, &width, &height, src->width, src->height)) return;
+    dst_x += x - src_x;
+    dst_y += y - src_y;
+    src_x = x;
+    src_y = y;
+    
+    x = dst_x;
+    y = dst_y;
+    if (!clip_rect(&x, &y, &width, &height, dst->width, dst->height)) return;
+    src_x += x - dst_x;
+    src_y += y - dst_y;
+    
+    int dst_bytes = dst->bpp / 8;
+    int src_bytes = src->bpp / 8;
+    uint8_t* out = dst->pixels + y * dst->pitch + x * dst_bytes;
+    const uint8_t* in = src->pixels + src_y * src->pitch + src_x * src_bytes;
+    int row_bytes = width * dst_bytes;
+    
+    if (expand) {
+        for (int dy = 0; dy < height; dy++) {
+            expand8to32((uint32_t*)out, in, width);
+            out += dst->pitch;
+            in += src->pitch;
+        }
+        return;
+    }
+    if (row_bytes == dst->pitch && row_bytes == src->pitch) {
+        memcpy(out, in, row_bytes * height);
+        return;
+    }
+    for (int dy = 0; dy < height; dy++) {
+        memcpy(out, in, row_bytes);
+        out += dst->pitch;
+        in += src->pitch;
+    }
+}
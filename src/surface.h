@@ -0,0 +1,33 @@
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include <stdint.h>
+
+// Supported pixel depths
+#define SURFACE_8BPP    8       // Palette indices (mode 13h, off-screen)
+#define SURFACE_32BPP   32      // XRGB8888 (VBE linear framebuffer)
+
+// A pixel buffer; pitch is the byte distance between rows so a surface can
+// describe the screen, an off-screen cache or a sub-rect
+typedef struct {
+    uint8_t* pixels;
+    int width;
+    int height;
+    int pitch;
+    int bpp;
+} surface_t;
+
+// Surface functions
+// Colors are always palette indices; 32bpp surfaces expand them through
+// the default VGA palette. Everything clips against the surface bounds and
+// works a row at a time with one address computation per row: 8bpp rows
+// use memset/memcpy (SSE2 kernels when available), 32bpp fills use a dword
+// store loop. Blits need equal depths, or an 8bpp source on a 32bpp target
+void surface_init(surface_t* surface, uint8_t* pixels, int width, int height, int pitch, int bpp);
+uint32_t surface_color(const surface_t* surface, uint8_t color);
+void surface_put_pixel(surface_t* surface, int x, int y, uint8_t color);
+void surface_fill_rect(surface_t* surface, int x, int y, int width, int height, uint8_t color);
+void surface_blit(surface_t* dst, int dst_x, int dst_y,
+                  const surface_t* src, int src_x, int src_y, int width, int height);
+
+#endif // SURFACE_H
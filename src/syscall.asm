@@ -0,0 +1,140 @@
+; syscall.asm - Ring 3 entry/exit and the SYSENTER system call path
+[BITS 32]
+
+; user_enter() drops to ring 3 with iret and remembers the kernel stack;
+; the SYS_EXIT handler calls user_exit(), which returns from user_enter()
+; on that stack. sysenter_entry builds the same interrupt_frame_t as
+; isr_common (isr.asm) so syscall_dispatch() serves both entry paths.
+
+extern syscall_dispatch
+
+global user_enter
+global user_exit
+global sysenter_entry
+global user_bench_int80
+global user_bench_sysenter
+
+KERNEL_DATA_SEG equ 0x10    ; Must match gdt.h
+USER_CODE_SEG equ 0x1B
+USER_DATA_SEG equ 0x23
+SYSCALL_VECTOR equ 0x80     ; Must match interrupts.h
+SYS_EXIT equ 0              ; Must match syscall.h
+SYS_NULL equ 7
+
+section .text
+
+; int user_enter(uint32_t entry, uint32_t user_esp)
+user_enter:
+    push ebp
+    push ebx
+    push esi
+    push edi
+    pushfd
+    mov [kernel_esp], esp
+
+    mov ecx, [esp + 24]         ; entry
+    mov edx, [esp + 28]         ; user_esp
+    mov ax, USER_DATA_SEG
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+
+    push dword USER_DATA_SEG    ; ss
+    push edx                    ; esp
+    pushfd
+    or dword [esp], 0x200       ; Ring 3 always runs with interrupts on
+    push dword USER_CODE_SEG    ; cs
+    push ecx                    ; eip
+
+    ; Leave no kernel values behind in registers
+    xor eax, eax
+    xor ebx, ebx
+    xor ecx, ecx
+    xor edx, edx
+    xor esi, esi
+    xor edi, edi
+    xor ebp, ebp
+    iretd
+
+; void user_exit(int status) - never returns to its caller
+user_exit:
+    mov eax, [esp + 4]
+    mov esp, [kernel_esp]
+    mov cx, KERNEL_DATA_SEG
+    mov ds, cx
+    mov es, cx
+    mov fs, cx
+    mov gs, cx
+    popfd
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret
+
+; SYSENTER lands here on the stack from MSR_SYSENTER_ESP with interrupts
+; off; ECX = user stack, EDX = user return address (syscall.h)
+sysenter_entry:
+    push dword USER_DATA_SEG    ; user_ss
+    push ecx                    ; user_esp
+    pushfd
+    push dword USER_CODE_SEG    ; cs
+    push edx                    ; eip
+    push dword 0                ; error_code
+    push dword SYSCALL_VECTOR   ; vector
+    pusha
+    push ds
+    push es
+
+    mov ax, KERNEL_DATA_SEG
+    mov ds, ax
+    mov es, ax
+    cld
+
+    push esp                    ; interrupt_frame_t*
+    call syscall_dispatch
+    add esp, 4
+
+    pop es
+    pop ds
+    popa
+    add esp, 8                  ; Vector and error code
+    mov edx, [esp]              ; eip
+    mov ecx, [esp + 12]         ; user_esp
+    add esp, 20
+    sti                         ; Takes effect after sysexit
+    sysexit
+
+section .bss
+kernel_esp resd 1
+
+; Ring 3 code for the syscall benchmarks. linker.ld gathers .usertext on
+; its own pages, which paging_init() maps user accessible. [esp + 4] is
+; the number of SYS_NULL calls to make
+section .usertext progbits alloc exec nowrite align=16
+
+user_bench_int80:
+    mov esi, [esp + 4]
+.loop:
+    mov eax, SYS_NULL
+    int SYSCALL_VECTOR
+    dec esi
+    jnz .loop
+    mov eax, SYS_EXIT
+    xor ebx, ebx
+    int SYSCALL_VECTOR
+
+user_bench_sysenter:
+    mov esi, [esp + 4]
+.loop:
+    mov eax, SYS_NULL
+    mov ecx, esp
+    mov edx, .return
+    sysenter
+.return:
+    dec esi
+    jnz .loop
+    mov eax, SYS_EXIT
+    xor ebx, ebx
+    int SYSCALL_VECTOR
@@ -0,0 +1,233 @@
+#include "syscall.h"
+#include "gdt.h"
+#include "paging.h"
+#include "fs.h"
+#include "frame.h"
+#include "pit.h"
+#include "cpu.h"
+#include "serial.h"
+#include "string.h"
+#include "trace.h"
+
+#define SYSCALL_STACK_SIZE  8192
+#define SYSCALL_PATH_MAX    128
+
+typedef int32_t (*syscall_t)(uint32_t arg0, uint32_t arg1, uint32_t arg2);
+
+typedef struct {
+    fs_node_t* node;
+    uint32_t offset;
+} syscall_file_t;
+
+// Entry points (syscall.asm)
+extern void sysenter_entry(void);
+extern int user_enter(uint32_t entry, uint32_t user_esp);
+extern void user_exit(int status);
+
+// Ring 0 stack for int 0x80, SYSENTER and interrupts taken in ring 3.
+// It is never paged out: a fault while the CPU pushes onto it cannot be
+// handled
+static uint8_t syscall_stack[SYSCALL_STACK_SIZE] __attribute__((aligned(16)));
+static int sysenter_available = 0;
+static strbuf_flush_t console = serial_write;
+static syscall_file_t files[SYSCALL_MAX_FILES];
+
+// User buffers must lie in user pages the program may access (writable
+// ones when the kernel stores into them). The kernel shares the address
+// space, so an unchecked pointer could name kernel memory, and a fault
+// on a bad pointer inside a system call would be a kernel fault
+static int user_range_ok(uint32_t address, uint32_t length, uint32_t access) {
+    if (address < PAGING_USER_BASE || address + length < address ||
+        address + length > PAGING_USER_STACK_TOP) {
+        return 0;
+    }
+    
+    uint32_t end = address + length;
+    for (uint32_t page = address & PAGE_MASK; page < end; page += PAGE_SIZE) {
+        vm_region_t* region = paging_find_region(page);
+        if (!region || (region->flags & VM_GUARD) || !(region->flags & PAGE_USER) ||
+            (region->flags & access) != access) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Milliseconds from the TSC (divl: there is no 64-bit divide helper)
+static uint32_t syscall_time_ms(void) {
+    uint32_t per_ms = frame_cycles_per_us() * 1000;
+    uint64_t cycles = cpu_rdtsc();
+    uint32_t high = (uint32_t)(cycles >> 32);
+    if (per_ms == 0 || high >= per_ms) return 0;
+    
+    uint32_t ms;
+    asm("divl %2" : "=a"(ms), "+d"(high) : "rm"(per_ms), "a"((uint32_t)cycles));
+    return ms;
+}
+
+static int32_t sys_exit(uint32_t status, uint32_t unused1, uint32_t unused2) {
+    user_exit((int)status);
+    return 0;
+}
+
+static int32_t sys_write(uint32_t fd, uint32_t buffer, uint32_t length) {
+    if (!user_range_ok(buffer, length, 0)) return SYSCALL_ERROR;
+    
+    if (fd == SYSCALL_STDOUT) {
+        console((const char*)(uintptr_t)buffer, length);
+        return length;
+    }
+    if (fd >= SYSCALL_MAX_FILES || !files[fd].node) return SYSCALL_ERROR;
+    
+    uint32_t written = fs_write(files[fd].node, files[fd].offset, length, (uint8_t*)(uintptr_t)buffer);
+    files[fd].offset += written;
+    return written;
+}
+
+static int32_t sys_read(uint32_t fd, uint32_t buffer, uint32_t length) {
+    if (!user_range_ok(buffer, length, PAGE_WRITE)) return SYSCALL_ERROR;
+    if (fd == SYSCALL_STDIN) return 0;  // No console input yet
+    if (fd >= SYSCALL_MAX_FILES || !files[fd].node) return SYSCALL_ERROR;
+    
+    uint32_t got = fs_read(files[fd].node, files[fd].offset, length, (uint8_t*)(uintptr_t)buffer);
+    files[fd].offset += got;
+    return got;
+}
+
+static int32_t sys_time(uint32_t unused0, uint32_t unused1, uint32_t unused2) {
+    return syscall_time_ms();
+}
+
+static int32_t sys_open(uint32_t path, uint32_t unused1, uint32_t unused2) {
+    // Copy the name in, checking every byte lies in user space
+    char name[SYSCALL_PATH_MAX];
+    uint32_t length = 0;
+    do {
+        if (length == SYSCALL_PATH_MAX || !user_range_ok(path + length, 1, 0)) return SYSCALL_ERROR;
+        name[length] = *(const char*)(uintptr_t)(path + length);
+    } while (name[length++]);
+    
+    fs_node_t* node = fs_find(name);
+    if (!node || FS_TYPE(node) != FS_FILE) return SYSCALL_ERROR;
+    
+    for (int fd = SYSCALL_STDOUT + 1; fd < SYSCALL_MAX_FILES; fd++) {
+        if (!files[fd].node) {
+            files[fd].node = node;
+            files[fd].offset = 0;
+            return fd;
+        }
+    }
+    return SYSCALL_ERROR;
+}
+
+static int32_t sys_close(uint32_t fd, uint32_t unused1, uint32_t unused2) {
+    if (fd <= SYSCALL_STDOUT || fd >= SYSCALL_MAX_FILES || !files[fd].node) return SYSCALL_ERROR;
+    files[fd].node = 0;
+    return 0;
+}
+
+// Sleep with interrupts on; halt between timer ticks when the PIT runs
+static int32_t sys_sleep(uint32_t ms, uint32_t unused1, uint32_t unused2) {
+    uint32_t start = syscall_time_ms();
+    cpu_enable_interrupts();
+    while (syscall_time_ms() - start < ms) {
+        if (pit_is_running()) {
+            asm volatile("hlt");
+        } else {
+            asm volatile("pause");
+        }
+    }
+    cpu_disable_interrupts();
+    return 0;
+}
+
+static int32_t sys_null(uint32_t unused0, uint32_t unused1, uint32_t unused2) {
+    return 0;
+}
+
+static const syscall_t syscall_table[SYSCALL_COUNT] = {
+    [SYS_EXIT] = sys_exit,
+    [SYS_WRITE] = sys_write,
+    [SYS_READ] = sys_read,
+    [SYS_TIME] = sys_time,
+    [SYS_OPEN] = sys_open,
+    [SYS_CLOSE] = sys_close,
+    [SYS_SLEEP] = sys_sleep,
+    [SYS_NULL] = sys_null,
+};
+
+// Called from isr_common (int 0x80) and sysenter_entry
+void syscall_dispatch(interrupt_frame_t* frame) {
+    uint32_t number = frame->eax;
+    if (number >= SYSCALL_COUNT) {
+        frame->eax = SYSCALL_ERROR;
+        return;
+    }
+    
+    trace_event(TRACE_SYSCALL_BEGIN, number, frame->ebx);
+    frame->eax = syscall_table[number](frame->ebx, frame->esi, frame->edi);
+    trace_event(TRACE_SYSCALL_END, frame->eax, 0);
+}
+
+// A fault in ring 3 ends the program instead of the kernel
+static void user_fault(interrupt_frame_t* frame) {
+    kprintf("\n*** Program killed: vector %u at 0x%08x ***\n", frame->vector, frame->eip);
+    user_exit(SYSCALL_ERROR);
+}
+
+static int cpu_has_sep(void) {
+    if (!cpu_has_cpuid()) return 0;
+    
+    uint32_t eax, ebx, ecx, edx;
+    cpu_cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (!(edx & CPUID_EDX_SEP)) return 0;
+    
+    // The Pentium Pro reports SEP but has no working SYSENTER
+    uint32_t family = (eax >> 8) & 0xF;
+    uint32_t model = (eax >> 4) & 0xF;
+    uint32_t stepping = eax & 0xF;
+    return !(family == 6 && model < 3 && stepping < 3);
+}
+
+void syscall_init(void) {
+    uint32_t stack_top = (uint32_t)(uintptr_t)(syscall_stack + SYSCALL_STACK_SIZE);
+    gdt_set_kernel_stack(stack_top);
+    
+    sysenter_available = cpu_has_sep();
+    if (sysenter_available) {
+        cpu_wrmsr(MSR_SYSENTER_CS, KERNEL_CODE_SEG);
+        cpu_wrmsr(MSR_SYSENTER_ESP, stack_top);
+        cpu_wrmsr(MSR_SYSENTER_EIP, (uint32_t)(uintptr_t)sysenter_entry);
+    }
+    
+    interrupt_register(SYSCALL_VECTOR, syscall_dispatch);
+    interrupt_set_user_fault(user_fault);
+    
+    uint32_t stack_base = PAGING_USER_STACK_TOP - PAGING_USER_STACK_SIZE;
+    paging_reserve(stack_base - PAGE_SIZE, PAGE_SIZE, VM_GUARD, "user stack guard", 0, 0);
+    paging_reserve(stack_base, PAGING_USER_STACK_SIZE, PAGE_USER | PAGE_WRITE, "user stack", 0, 0);
+}
+
+int syscall_has_sysenter(void) {
+    return sysenter_available;
+}
+
+// Where SYS_WRITE to stdout goes (serial by default)
+void syscall_set_console(strbuf_flush_t output) {
+    console = output ? output : serial_write;
+}
+
+int syscall_run_user(uint32_t entry, uint32_t arg) {
+    // cdecl-style frame: a (never used) return address, then arg
+    uint32_t* stack = (uint32_t*)(uintptr_t)PAGING_USER_STACK_TOP;
+    stack[-1] = arg;
+    stack[-2] = 0;
+    
+    int status = user_enter(entry, (uint32_t)(uintptr_t)(stack - 2));
+    
+    // Files the program left open
+    for (int fd = SYSCALL_STDOUT + 1; fd < SYSCALL_MAX_FILES; fd++) {
+        files[fd].node = 0;
+    }
+    return status;
+}
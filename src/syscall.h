@@ -0,0 +1,46 @@
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+#include <stdint.h>
+#include "interrupts.h"
+#include "kprintf.h"
+
+// System call ABI (both entry paths):
+//   EAX = number, EBX/ESI/EDI = arguments, result in EAX (negative on error)
+// int 0x80 works everywhere. SYSENTER is used when the CPU has SEP; the
+// caller puts its stack pointer in ECX and the return address in EDX,
+// which SYSEXIT resumes at (ECX and EDX are not preserved).
+#define SYS_EXIT            0   // status
+#define SYS_WRITE           1   // fd, buffer, length
+#define SYS_READ            2   // fd, buffer, length
+#define SYS_TIME            3   // Milliseconds since power-on
+#define SYS_OPEN            4   // path
+#define SYS_CLOSE           5   // fd
+#define SYS_SLEEP           6   // milliseconds
+#define SYS_NULL            7   // Does nothing; times the entry path
+#define SYSCALL_COUNT       8
+
+#define SYSCALL_ERROR       -1
+
+// File descriptors: 0 and 1 are the console, the rest are VFS files
+#define SYSCALL_STDIN       0
+#define SYSCALL_STDOUT      1
+#define SYSCALL_MAX_FILES   8
+
+// System call functions
+// syscall_init() programs the SYSENTER MSRs (when SEP is present), sets
+// the ring 0 stack and reserves the user stack. syscall_run_user() enters
+// ring 3 at entry with arg as its only stack argument and returns the
+// status the program passes to SYS_EXIT (-1 if it faults)
+void syscall_init(void);
+int syscall_has_sysenter(void);
+void syscall_set_console(strbuf_flush_t console);
+int syscall_run_user(uint32_t entry, uint32_t arg);
+void syscall_dispatch(interrupt_frame_t* frame);
+
+// Ring 3 benchmark loops (syscall.asm): issue SYS_NULL arg times through
+// one entry path, then exit
+extern void user_bench_int80(void);
+extern void user_bench_sysenter(void);
+
+#endif // SYSCALL_H
@@ -0,0 +1,25 @@
+; task.asm - Kernel task context switch
+[BITS 32]
+
+; Only the callee-saved registers are switched; everything else is
+; already saved by the C caller of task_switch().
+
+global task_switch
+
+section .text
+
+; void task_switch(uint32_t* save_esp, uint32_t next_esp)
+task_switch:
+    mov eax, [esp + 4]
+    mov edx, [esp + 8]
+    push ebp
+    push ebx
+    push esi
+    push edi
+    mov [eax], esp
+    mov esp, edx
+    pop edi
+    pop esi
+    pop ebx
+    pop ebp
+    ret
@@ -0,0 +1,129 @@
+#include "task.h"
+#include "paging.h"
+#include "cpu.h"
+#include "string.h"
+#include "fpu.h"
+
+#define TASK_FREE           0
+#define TASK_READY          1
+#define TASK_BLOCKED        2
+
+typedef struct {
+    int state;
+    const char* name;
+    uint32_t esp;               // Saved by task_switch() while not running
+    uint32_t stack_top;         // Kept when the slot is reused
+    task_entry_t entry;
+    void* arg;
+    volatile uint32_t* futex;   // Word a blocked task waits on
+    fpu_state_t fpu;            // x87/SSE registers while not running
+} task_t;
+
+// Context switch (task.asm)
+extern void task_switch(uint32_t* save_esp, uint32_t next_esp);
+
+static task_t tasks[TASK_MAX];
+static int current = 0;
+
+// First code a new task runs: task_switch() returns here
+static void task_start(void) {
+    task_t* task = &tasks[current];
+    task->entry(task->arg);
+    task_exit();
+}
+
+void task_init(void) {
+    memset(tasks, 0, sizeof(tasks));
+    tasks[0].state = TASK_READY;
+    tasks[0].name = "boot";
+    current = 0;
+}
+
+int task_create(const char* name, task_entry_t entry, void* arg) {
+    int id = 1;
+    while (id < TASK_MAX && tasks[id].state != TASK_FREE) id++;
+    if (id == TASK_MAX) return -1;
+    
+    task_t* task = &tasks[id];
+    if (!task->stack_top) {
+        task->stack_top = paging_alloc_stack(TASK_STACK_SIZE);
+        if (!task->stack_top) return -1;
+    
+        // Commit the stack now: a not-present fault while the CPU pushes
+        // an interrupt frame onto it could not be handled
+        for (uint32_t page = task->stack_top - TASK_STACK_SIZE; page < task->stack_top; page += PAGE_SIZE) {
+            *(volatile uint32_t*)page = 0;
+        }
+    }
+    
+    // Initial frame for task_switch(): edi, esi, ebx, ebp, return address
+    uint32_t* sp = (uint32_t*)(uintptr_t)task->stack_top;
+    *--sp = 0;                                  // task_start never returns
+    *--sp = (uint32_t)(uintptr_t)task_start;
+    for (int i = 0; i < 4; i++) *--sp = 0;
+    
+    task->esp = (uint32_t)(uintptr_t)sp;
+    fpu_init_state(&task->fpu);
+    task->name = name;
+    task->entry = entry;
+    task->arg = arg;
+    task->futex = 0;
+    task->state = TASK_READY;
+    return id;
+}
+
+// Switch to the next ready task after the current one. With none ready
+// the CPU idles until an interrupt handler wakes one
+static void task_schedule(void) {
+    for (;;) {
+        for (int i = 1; i <= TASK_MAX; i++) {
+            int next = (current + i) % TASK_MAX;
+            if (tasks[next].state != TASK_READY) continue;
+            if (next == current) return;
+    
+            int previous = current;
+            current = next;
+            fpu_switch(&tasks[previous].fpu, &tasks[next].fpu);
+            task_switch(&tasks[previous].esp, tasks[next].esp);
+            return;
+        }
+        uint32_t flags = cpu_irq_save();
+        cpu_enable_interrupts();
+        asm volatile("hlt");
+        if (!(flags & EFLAGS_IF)) cpu_disable_interrupts();
+    }
+}
+
+void task_yield(void) {
+    task_schedule();
+}
+
+void task_exit(void) {
+    tasks[current].state = TASK_FREE;
+    task_schedule();
+}
+
+int task_current(void) {
+    return current;
+}
+
+int futex_wait(volatile uint32_t* address, uint32_t expected) {
+    if (*address != expected) return -1;
+    
+    tasks[current].futex = address;
+    tasks[current].state = TASK_BLOCKED;
+    task_schedule();
+    return 0;
+}
+
+int futex_wake(volatile uint32_t* address, int count) {
+    int woken = 0;
+    for (int i = 0; i < TASK_MAX && woken < count; i++) {
+        if (tasks[i].state == TASK_BLOCKED && tasks[i].futex == address) {
+            tasks[i].futex = 0;
+            tasks[i].state = TASK_READY;
+            woken++;
+        }
+    }
+    return woken;
+}
@@ -0,0 +1,26 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdint.h>
+
+// Cooperative kernel tasks: a task runs until it yields, blocks in
+// futex_wait() or exits. Task 0 is the boot context (the main loop)
+#define TASK_MAX            8
+#define TASK_STACK_SIZE     (16 * 1024)
+
+typedef void (*task_entry_t)(void* arg);
+
+// Task functions
+void task_init(void);
+int task_create(const char* name, task_entry_t entry, void* arg);
+void task_yield(void);
+void task_exit(void);
+int task_current(void);
+
+// Futex-style blocking on a word: futex_wait() sleeps only while
+// *address still equals expected (returns -1 at once otherwise);
+// futex_wake() readies up to count tasks waiting on address
+int futex_wait(volatile uint32_t* address, uint32_t expected);
+int futex_wake(volatile uint32_t* address, int count);
+
+#endif // TASK_H
@@ -132,6 +132,10 @@ void show_loading_screen(void) {
     // Draw loading bar background
     draw_rectangle(60, 100, 200, 20, COLOR_GRAY);
     
+#ifdef FAST_BOOT
+    // Fast boot: nothing to wait for, fill the bar at once
+    draw_rectangle(60, 102, 200, 16, COLOR_GREEN);
+#else
     // Animate progress bar (5 seconds total)
     for (int progress = 0; progress <= 200; progress += 2) {
         // Draw progress bar
@@ -140,12 +144,15 @@ void show_loading_screen(void) {
         // Delay for timing (approximately 25ms per step)
         for (volatile int delay = 0; delay < 100000; delay++);
     }
+#endif
     
     // Show completion message
     draw_string(72, 130, "Loading Complete!", COLOR_BRIGHT_GREEN, 2);
     
+#ifndef FAST_BOOT
     // Final delay
     for (volatile int delay = 0; delay < 2000000; delay++);
+#endif
 }
 
 #endif // TEXT_DRIVER_H
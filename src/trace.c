@@ -0,0 +1,148 @@
+#include "trace.h"
+#include "cpu.h"
+#include "string.h"
+
+// One ring per CPU. Writers claim a slot with an atomic increment of head,
+// so IRQ handlers can trace while the interrupted code is mid-event; the
+// slot's seq field is stored last and tells the reader the slot is complete.
+typedef struct {
+    volatile uint32_t head;     // Total events ever claimed
+    trace_event_t events[TRACE_RING_SIZE];
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_MAX_CPUS];
+static volatile int enabled = 0;
+
+// Name and Chrome trace phase ('B' begin, 'E' end, 'i' instant) per id
+static const struct {
+    const char* name;
+    char phase;
+} event_info[TRACE_EVENT_COUNT] = {
+    [TRACE_NONE]             = {"none", 'i'},
+    [TRACE_IRQ_ENTER]        = {"irq", 'B'},
+    [TRACE_IRQ_EXIT]         = {"irq", 'E'},
+    [TRACE_CLI_INPUT_BEGIN]  = {"cli_handle_input", 'B'},
+    [TRACE_CLI_INPUT_END]    = {"cli_handle_input", 'E'},
+    [TRACE_FS_FIND_BEGIN]    = {"fs_find", 'B'},
+    [TRACE_FS_FIND_END]      = {"fs_find", 'E'},
+    [TRACE_FS_READ_BEGIN]    = {"fs_read", 'B'},
+    [TRACE_FS_READ_END]      = {"fs_read", 'E'},
+    [TRACE_FS_WRITE_BEGIN]   = {"fs_write", 'B'},
+    [TRACE_FS_WRITE_END]     = {"fs_write", 'E'},
+    [TRACE_FS_READDIR_BEGIN] = {"fs_readdir", 'B'},
+    [TRACE_FS_READDIR_END]   = {"fs_readdir", 'E'},
+    [TRACE_FS_MKDIR_BEGIN]   = {"fs_mkdir", 'B'},
+    [TRACE_FS_MKDIR_END]     = {"fs_mkdir", 'E'},
+    [TRACE_FS_CREATE_BEGIN]  = {"fs_create_file", 'B'},
+    [TRACE_FS_CREATE_END]    = {"fs_create_file", 'E'},
+    [TRACE_MALLOC]           = {"malloc", 'i'},
+    [TRACE_FREE]             = {"free", 'i'},
+    [TRACE_PRESENT_BEGIN]    = {"present", 'B'},
+    [TRACE_PRESENT_END]      = {"present", 'E'},
+    [TRACE_CLI_DRAW_BEGIN]   = {"cli_draw", 'B'},
+    [TRACE_CLI_DRAW_END]     = {"cli_draw", 'E'},
+    [TRACE_COMPOSE_BEGIN]    = {"compose", 'B'},
+    [TRACE_COMPOSE_END]      = {"compose", 'E'},
+    [TRACE_FRAME_WAIT_BEGIN] = {"frame_wait", 'B'},
+    [TRACE_FRAME_WAIT_END]   = {"frame_wait", 'E'},
+    [TRACE_SYSCALL_BEGIN]    = {"syscall", 'B'},
+    [TRACE_SYSCALL_END]      = {"syscall", 'E'},
+    [TRACE_MARK]             = {"mark", 'i'},
+};
+
+void trace_init(void) {
+    trace_clear();
+    enabled = 1;
+}
+
+void trace_enable(int on) {
+    enabled = on;
+}
+
+int trace_is_enabled(void) {
+    return enabled;
+}
+
+void trace_clear(void) {
+    uint32_t flags = cpu_irq_save();
+    memset(rings, 0, sizeof(rings));
+    cpu_irq_restore(flags);
+}
+
+// Record one event on the current CPU (always CPU 0 for now)
+void trace_event(uint16_t id, uint32_t arg0, uint32_t arg1) {
+    if (!enabled) {
+        return;
+    }
+    
+    trace_ring_t* ring = &rings[0];
+    uint32_t seq = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_event_t* event = &ring->events[seq & (TRACE_RING_SIZE - 1)];
+    
+    event->tsc = cpu_rdtsc();
+    event->id = id;
+    event->cpu = 0;
+    event->arg0 = arg0;
+    event->arg1 = arg1;
+    __atomic_store_n(&event->seq, seq, __ATOMIC_RELEASE);
+}
+
+// Events currently held in the rings
+uint32_t trace_count(void) {
+    uint32_t count = 0;
+    for (int cpu = 0; cpu < TRACE_MAX_CPUS; cpu++) {
+        uint32_t head = rings[cpu].head;
+        count += head < TRACE_RING_SIZE ? head : TRACE_RING_SIZE;
+    }
+    return count;
+}
+
+// Write the rings oldest first as text, one event per line:
+//   TRACE-BEGIN cpus=<n> events=<n> dropped=<n>
+//   T <cpu> <seq> <tsc> <phase> <name> <arg0> <arg1>
+//   TRACE-END
+// scripts/trace2json.py turns this into Chrome trace JSON. Tracing is
+// paused while dumping so the output is a consistent snapshot.
+void trace_dump(strbuf_flush_t out) {
+    char buf[128];
+    strbuf_t sb;
+    strbuf_init(&sb, buf, sizeof(buf));
+    sb.flush = out;
+    
+    int was_enabled = enabled;
+    enabled = 0;
+    
+    uint32_t dropped = 0;
+    for (int cpu = 0; cpu < TRACE_MAX_CPUS; cpu++) {
+        uint32_t head = rings[cpu].head;
+        if (head > TRACE_RING_SIZE) {
+            dropped += head - TRACE_RING_SIZE;
+        }
+    }
+    strbuf_printf(&sb, "TRACE-BEGIN cpus=%d events=%u dropped=%u\n",
+                  TRACE_MAX_CPUS, trace_count(), dropped);
+    
+    for (int cpu = 0; cpu < TRACE_MAX_CPUS; cpu++) {
+        trace_ring_t* ring = &rings[cpu];
+        uint32_t head = ring->head;
+        uint32_t seq = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+        
+        for (; seq != head; seq++) {
+            trace_event_t* event = &ring->events[seq & (TRACE_RING_SIZE - 1)];
+            if (__atomic_load_n(&event->seq, __ATOMIC_ACQUIRE) != seq ||
+                event->id >= TRACE_EVENT_COUNT) {
+                continue; // Claimed but never completed
+            }
+            strbuf_printf(&sb, "T %u %u %llu %c %s %u %u\n", event->cpu, seq,
+                          event->tsc, event_info[event->id].phase,
+                          event_info[event->id].name, event->arg0, event->arg1);
+        }
+    }
+    
+    strbuf_puts(&sb, "TRACE-END\n");
+    if (sb.len > 0) {
+        out(sb.buf, sb.len);
+    }
+    
+    enabled = was_enabled;
+}
@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "kprintf.h"
+
+// Trace ring limits (events per CPU, must be a power of two)
+#define TRACE_MAX_CPUS      1
+#define TRACE_RING_SIZE     1024
+
+// Event ids; *_BEGIN/*_END pairs become duration slices in the viewer
+enum {
+    TRACE_NONE = 0,
+    TRACE_IRQ_ENTER,        // arg0 = IRQ line
+    TRACE_IRQ_EXIT,
+    TRACE_CLI_INPUT_BEGIN,
+    TRACE_CLI_INPUT_END,
+    TRACE_FS_FIND_BEGIN,
+    TRACE_FS_FIND_END,      // arg0 = found node (0 if none)
+    TRACE_FS_READ_BEGIN,    // arg0 = inode, arg1 = size
+    TRACE_FS_READ_END,      // arg0 = bytes read
+    TRACE_FS_WRITE_BEGIN,   // arg0 = inode, arg1 = size
+    TRACE_FS_WRITE_END,     // arg0 = bytes written
+    TRACE_FS_READDIR_BEGIN, // arg0 = inode, arg1 = index
+    TRACE_FS_READDIR_END,
+    TRACE_FS_MKDIR_BEGIN,   // arg0 = parent inode
+    TRACE_FS_MKDIR_END,     // arg0 = result
+    TRACE_FS_CREATE_BEGIN,  // arg0 = parent inode
+    TRACE_FS_CREATE_END,    // arg0 = result
+    TRACE_MALLOC,           // arg0 = size, arg1 = pointer
+    TRACE_FREE,             // arg0 = pointer
+    TRACE_PRESENT_BEGIN,
+    TRACE_PRESENT_END,
+    TRACE_CLI_DRAW_BEGIN,
+    TRACE_CLI_DRAW_END,
+    TRACE_COMPOSE_BEGIN,    // arg0 = damage rects
+    TRACE_COMPOSE_END,      // arg0 = pixels written
+    TRACE_FRAME_WAIT_BEGIN,
+    TRACE_FRAME_WAIT_END,
+    TRACE_SYSCALL_BEGIN,    // arg0 = number, arg1 = first argument
+    TRACE_SYSCALL_END,      // arg0 = result
+    TRACE_MARK,             // Free-form marker
+    TRACE_EVENT_COUNT
+};
+
+// Fixed-size binary event
+typedef struct {
+    uint64_t tsc;
+    uint32_t seq;           // Ring position, written last (marks the slot valid)
+    uint16_t id;
+    uint16_t cpu;
+    uint32_t arg0;
+    uint32_t arg1;
+} trace_event_t;
+
+// Trace functions
+void trace_init(void);
+void trace_enable(int enabled);
+int trace_is_enabled(void);
+void trace_clear(void);
+void trace_event(uint16_t id, uint32_t arg0, uint32_t arg1);
+uint32_t trace_count(void);
+void trace_dump(strbuf_flush_t out);
+
+#endif // TRACE_H
@@ -0,0 +1,89 @@
+[BITS 32]
+[ORG 0]
+
+; unpack.asm - Self-decompressing kernel stub
+; scripts/pack_kernel.py appends this stub after an LZ4 compressed copy of
+; kernel.bin and fills in the parameter block below. Stage 2 loads the
+; packed image and jumps here in protected mode; the stub decodes the
+; payload to the kernel's link address (KERNEL_BASE in linker.ld) and
+; jumps to the real kernel entry point.
+;
+; The packer places the payload so that it overlaps the end of the
+; decompressed kernel, letting the output grow over input that has already
+; been consumed. The stub itself sits after the payload so it is never
+; overwritten. Its load address is only known to the
+; packer, so the code is position independent.
+
+unpack_start:
+    jmp short unpack_main
+
+    align 4
+unpack_params:                 ; Patched by the packer
+p_src       dd 0               ; Payload address
+p_size      dd 0               ; Payload size in bytes
+p_dest      dd 0               ; Kernel link address
+p_entry     dd 0               ; Kernel entry point
+
+unpack_main:
+    cld
+    call .here
+.here:
+    pop ebp                    ; EBP = runtime address of .here
+
+    mov esi, [ebp + p_src - .here]
+    mov edx, esi
+    add edx, [ebp + p_size - .here]     ; EDX = end of payload
+    mov edi, [ebp + p_dest - .here]
+
+; LZ4 block decoder
+; ESI = input, EDX = input end, EDI = output
+.next_sequence:
+    movzx ebx, byte [esi]      ; Token
+    inc esi
+
+    ; Literal length (high nibble, 15 = more length bytes follow)
+    mov ecx, ebx
+    shr ecx, 4
+    cmp ecx, 15
+    jne .copy_literals
+.literal_ext:
+    movzx eax, byte [esi]
+    inc esi
+    add ecx, eax
+    cmp eax, 255
+    je .literal_ext
+
+.copy_literals:
+    rep movsb
+
+    ; The last sequence carries literals only
+    cmp esi, edx
+    jae .done
+
+    ; Match offset (little endian 16-bit)
+    movzx eax, word [esi]
+    add esi, 2
+
+    ; Match length (low nibble + 4, 15 = more length bytes follow)
+    mov ecx, ebx
+    and ecx, 0x0F
+    cmp ecx, 15
+    jne .copy_match
+.match_ext:
+    movzx ebx, byte [esi]
+    inc esi
+    add ecx, ebx
+    cmp ebx, 255
+    je .match_ext
+
+.copy_match:
+    add ecx, 4
+    push esi
+    mov esi, edi
+    sub esi, eax
+    rep movsb                  ; Byte copy handles overlapping matches
+    pop esi
+    jmp .next_sequence
+
+.done:
+    jmp [ebp + p_entry - .here]
@@ -0,0 +1,82 @@
+; test.asm - /bin/test.exe, a minimal ELF32 program for the ELF loader
+; nasm -f bin user/test.asm -o test.exe
+; The ELF and program headers are written by hand so the whole file stays
+; small enough to embed in fs.c (test_exe[]). The first PT_LOAD segment
+; maps the headers and code read-only, the second maps an initialised
+; counter and a zero-filled .bss page read-write. The program runs in
+; ring 3: it prints a line through SYS_WRITE and exits with status 42.
+[BITS 32]
+[ORG 0]
+
+BASE        equ 0x08048000
+DATA_OFFSET equ data - $$
+DATA_ADDR   equ BASE + 0x1000 + DATA_OFFSET  ; Next page, same page offset
+BSS_ADDR    equ BASE + 0x2000
+BSS_SIZE    equ 4
+
+SYSCALL_VECTOR equ 0x80     ; Must match src/syscall.h
+SYS_EXIT    equ 0
+SYS_WRITE   equ 1
+STDOUT      equ 1
+
+ehdr:
+    db 0x7F, 'ELF', 1, 1, 1, 0      ; ELFCLASS32, little endian, version 1
+    times 8 db 0
+    dw 2                            ; e_type: ET_EXEC
+    dw 3                            ; e_machine: EM_386
+    dd 1                            ; e_version
+    dd BASE + _start                ; e_entry
+    dd phdrs - $$                   ; e_phoff
+    dd 0                            ; e_shoff
+    dd 0                            ; e_flags
+    dw ehdr_size                    ; e_ehsize
+    dw phdr_size                    ; e_phentsize
+    dw 2                            ; e_phnum
+    dw 0, 0, 0                      ; e_shentsize, e_shnum, e_shstrndx
+ehdr_size equ $ - ehdr
+
+phdrs:
+    ; Text: headers and code, R+X
+    dd 1                            ; p_type: PT_LOAD
+    dd 0                            ; p_offset
+    dd BASE                         ; p_vaddr
+    dd BASE                         ; p_paddr
+    dd text_end - $$                ; p_filesz
+    dd text_end - $$                ; p_memsz
+    dd 5                            ; p_flags: PF_R | PF_X
+    dd 0x1000                       ; p_align
+phdr_size equ $ - phdrs
+
+    ; Data and .bss, R+W
+    dd 1
+    dd DATA_OFFSET
+    dd DATA_ADDR
+    dd DATA_ADDR
+    dd data_end - data
+    dd BSS_ADDR + BSS_SIZE - DATA_ADDR
+    dd 6                            ; PF_R | PF_W
+    dd 0x1000
+
+_start:
+    mov eax, SYS_WRITE
+    mov ebx, STDOUT
+    mov esi, BASE + message
+    mov edi, message_size
+    int SYSCALL_VECTOR
+
+    mov ebx, [DATA_ADDR]            ; counter (42 in the file)
+    add ebx, [BSS_ADDR]             ; Zero-filled on first touch
+    inc dword [DATA_ADDR]           ; Private copy, the file is unchanged
+    mov [BSS_ADDR], ebx
+    mov eax, SYS_EXIT
+    int SYSCALL_VECTOR
+
+message:
+    db "Hello from /bin/test.exe", 10
+message_size equ $ - message
+text_end:
+
+    align 4, db 0
+data:
+    dd 42                           ; counter
+data_end: